@@ -0,0 +1,88 @@
+// Compares ticking ants in the order they were born with ticking them sorted by location, at several densities
+// Sorted ants read the tiles around them in roughly the order the tiles are stored, so fewer of those reads miss cache
+//
+// Usage: ant_order_benchmark [ticks] [rows] [columns]
+
+#include <ant_sim_project/simulation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <print>
+#include <string>
+
+namespace {
+
+using namespace ant_sim;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+// Ants per tile
+constexpr double densities[] = {0.01, 0.05, 0.2};
+
+// 0 leaves the ants in the order they were born
+constexpr tick_t sort_intervals[] = {0, 8, 32, 128};
+
+constexpr nest_id_t nest_count = 64;
+
+// Ants start on their nests, so they are given time to spread out before ticks are timed
+constexpr tick_t warm_up_ticks = 200;
+
+struct result {
+    double ns_per_ant_tick;
+    std::size_t ant_count;
+};
+
+result run(simulation_args_t args, tick_t ticks) {
+    args.log_events = false;
+
+    simulation sim{args};
+    sim.set_log_ant_state_changes(false);
+
+    while(sim.get_tick_count() < warm_up_ticks && !sim.stopped()) {
+        sim.tick();
+    }
+
+    auto ant_ticks = 0uz;
+    auto start = benchmark_clock::now();
+
+    while(sim.get_tick_count() < warm_up_ticks + ticks && !sim.stopped()) {
+        ant_ticks += sim.get_ants().size();
+        sim.tick();
+    }
+
+    auto elapsed = std::chrono::duration<double, std::nano>{benchmark_clock::now() - start};
+
+    return {elapsed.count() / static_cast<double>(std::max(ant_ticks, 1uz)), sim.get_ants().size()};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    tick_t ticks = argc > 1 ? static_cast<tick_t>(std::stoul(argv[1])) : 200;
+
+    simulation_args_t args = {};
+    args.seed = 42;
+    args.rows = argc > 2 ? std::stoull(argv[2]) : 1024;
+    args.columns = argc > 3 ? std::stoull(argv[3]) : 1024;
+    args.nest_count = nest_count;
+
+    // Ants don't starve, so every run keeps the density it started with
+    args.hunger_to_die = 1e9f;
+
+    std::println("Order,density,sort_interval,ants,ns_per_ant_tick");
+
+    for(auto density : densities) {
+        auto tile_count = static_cast<double>(args.rows * args.columns);
+
+        args.ant_count_per_nest = static_cast<ant_id_t>(density * tile_count / nest_count);
+
+        for(auto interval : sort_intervals) {
+            args.ant_sort_interval = interval;
+
+            auto [ns_per_ant_tick, ant_count] = run(args, ticks);
+
+            std::println("Order,{},{},{},{:.2f}", density, interval, ant_count, ns_per_ant_tick);
+        }
+    }
+}
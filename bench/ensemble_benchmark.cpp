@@ -0,0 +1,85 @@
+// Compares running replicas as separate instances, one after another as a sweep does, with running them as an ensemble
+//
+// Usage: ensemble_benchmark [replicas] [ticks] [rows] [columns]
+
+#include <ant_sim_project/ensemble.hpp>
+#include <ant_sim_project/simulation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ant_sim;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+double seconds_since(benchmark_clock::time_point start) {
+    return std::chrono::duration<double>{benchmark_clock::now() - start}.count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t replica_count = argc > 1 ? std::stoull(argv[1]) : 16;
+    tick_t ticks = argc > 2 ? static_cast<tick_t>(std::stoul(argv[2])) : 2000;
+
+    simulation_args_t args = {};
+    args.rows = argc > 3 ? std::stoull(argv[3]) : 500;
+    args.columns = argc > 4 ? std::stoull(argv[4]) : 500;
+    args.nest_count = 4;
+    args.ant_count_per_nest = 100;
+    args.log_events = false;
+
+    std::vector<std::uint64_t> seeds(replica_count);
+
+    for(auto i = 0uz; i < replica_count; i++) {
+        seeds[i] = i;
+    }
+
+    auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::println("Ensemble,mode,replicas,threads,seconds,replica_ticks_per_second");
+
+    auto report = [&](const char* mode, unsigned threads, double seconds) {
+        auto replica_ticks = static_cast<double>(replica_count) * ticks;
+
+        std::println("Ensemble,{},{},{},{:.3f},{:.1f}", mode, replica_count, threads, seconds, replica_ticks / seconds);
+    };
+
+    // Separate instances, created and run one at a time
+    {
+        auto start = benchmark_clock::now();
+
+        for(auto seed : seeds) {
+            args.seed = seed;
+
+            simulation sim{args};
+            sim.set_log_ant_state_changes(false);
+
+            while(sim.get_tick_count() < ticks && !sim.stopped()) {
+                sim.tick();
+            }
+        }
+
+        report("separate", 1, seconds_since(start));
+    }
+
+    // The same replicas as an ensemble, on one thread and on every hardware thread
+    for(auto threads : {1u, hardware_threads}) {
+        auto start = benchmark_clock::now();
+
+        ensemble replicas{args, seeds};
+        replicas.run(ticks, threads, 100);
+
+        report("ensemble", threads, seconds_since(start));
+
+        if(hardware_threads == 1) break;
+    }
+}
@@ -0,0 +1,121 @@
+// Compares the row-major and Morton layouts of the world grid
+// Random walkers read the 3x3 neighbourhood around themselves each step, like ants deciding where to move next
+//
+// Usage: layout_benchmark [steps per walker] [MiB per grid]
+
+#include <ant_sim_project/grid.hpp>
+#include <ant_sim_project/tile.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <print>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace ant_sim;
+
+constexpr std::size_t walker_count = 1 << 16;
+
+constexpr std::size_t widths[] = {256, 1024, 4096, 16384, 65536};
+
+struct walker {
+    std::size_t x;
+    std::size_t y;
+};
+
+// Reads the part of an element that ant movement reads
+std::size_t read(const tile& tile) { return tile.flags; }
+std::size_t read(const tile_contents& contents) { return contents.pheromones.get_strength(0, 0) != 0; }
+
+// Only one nest writes pheromones, so every entry fits within its tile and the pool stays empty
+tile::pheromone_pool pheromone_pool;
+
+void write(tile& tile, std::size_t i) { tile.set_has_food(i % 7 == 0); }
+void write(tile_contents& contents, std::size_t i) {
+    contents.pheromones.set(0, 0, static_cast<float>(i % 7), 0, 0, pheromone_pool);
+}
+
+// Returns the average time taken to read one neighbourhood, in nanoseconds
+template <typename T, typename Layout>
+double run(std::size_t rows, std::size_t columns, std::size_t steps, std::size_t& checksum) {
+    dense_grid<T, Layout> grid{rows, columns};
+
+    // Commit every page, so that reads aren't all served by the shared zero page
+    auto i = 0uz;
+    grid.for_each([&](T& element) { write(element, i++); });
+
+    auto elements = std::as_const(grid).span();
+
+    std::minstd_rand rng{42};
+
+    std::vector<walker> walkers(walker_count);
+
+    for(auto& walker : walkers) {
+        walker = {rng() % columns, rng() % rows};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(auto step = 0uz; step < steps; step++) {
+        for(auto& [x, y] : walkers) {
+            auto min_x = x == 0 ? 0 : x - 1;
+            auto min_y = y == 0 ? 0 : y - 1;
+            auto max_x = std::min(x + 1, columns - 1);
+            auto max_y = std::min(y + 1, rows - 1);
+
+            auto neighbourhood = 0uz;
+
+            for(auto neighbor_y = min_y; neighbor_y <= max_y; neighbor_y++) {
+                for(auto neighbor_x = min_x; neighbor_x <= max_x; neighbor_x++) {
+                    neighbourhood += read(elements[neighbor_y, neighbor_x]);
+                }
+            }
+
+            checksum += neighbourhood;
+
+            // Move to a neighbor that depends on what was read, like an ant would
+            auto direction = rng() + neighbourhood;
+
+            x = std::clamp<std::size_t>(x + direction % 3, 1, columns) - 1;
+            y = std::clamp<std::size_t>(y + direction / 3 % 3, 1, rows) - 1;
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::nano>{std::chrono::steady_clock::now() - start};
+
+    return elapsed.count() / static_cast<double>(steps * walker_count);
+}
+
+template <typename T>
+void compare_layouts(const char* name, std::size_t area, std::size_t steps, std::size_t& checksum) {
+    for(auto width : widths) {
+        auto rows = std::max(area / width, 1uz);
+
+        auto row_major = run<T, stdex::layout_right>(rows, width, steps, checksum);
+        auto morton = run<T, layout_morton>(rows, width, steps, checksum);
+
+        std::println("Layout,{},{},{},{:.2f},{:.2f}", name, width, rows, row_major, morton);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t steps = argc > 1 ? std::stoull(argv[1]) : 16;
+    std::size_t grid_bytes = (argc > 2 ? std::stoull(argv[2]) : 256) << 20;
+
+    std::size_t checksum = 0;
+
+    std::println("Layout,element,width,rows,row_major_ns,morton_ns");
+
+    // The grids should be larger than the last level cache, so that the layouts' effect on cache misses shows
+    compare_layouts<tile>("tile", grid_bytes / sizeof(tile), steps, checksum);
+    compare_layouts<tile_contents>("tile_contents", grid_bytes / sizeof(tile_contents), steps, checksum);
+
+    std::println("Checksum,{}", checksum);
+}
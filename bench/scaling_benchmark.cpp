@@ -0,0 +1,339 @@
+// Measures how whole runs scale with the size of the world, the number of ants and nests, and the number of threads
+// Each scenario runs fixed seeds for a fixed number of ticks, with as many replicas as threads
+//
+// Usage: scaling_benchmark [--suite quick|full] [--ticks <ticks>] [--output <report.json>]
+//                          [--baseline <report.json>] [--threshold <fraction>]
+// With a baseline, scenarios that got slower by more than the threshold (default 0.1) are reported as regressions,
+// and the exit code is 1 if there were any
+
+#include <ant_sim_project/ensemble.hpp>
+#include <ant_sim_project/simulation.hpp>
+
+#include <ant_sim_project/version.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define ANT_SIM_HAS_FORK
+#endif
+
+namespace {
+
+using namespace ant_sim;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+struct scenario_t {
+    const char* name;
+    std::size_t size; // The world is size x size tiles
+    nest_id_t nest_count;
+    ant_id_t ant_count_per_nest;
+    unsigned thread_count;
+    bool full_only; // Too large for the quick suite
+};
+
+// Each group varies one thing, starting from 1000x1000 tiles with 4 nests of 100 ants on one thread
+// clang-format off
+constexpr scenario_t scenarios[] = {
+    {"world_100", 100, 4, 100, 1, false},
+    {"world_1000", 1000, 4, 100, 1, false},
+    {"world_4000", 4000, 4, 100, 1, false},
+    {"world_10000", 10000, 4, 100, 1, true},
+    {"ants_10", 2000, 1, 10, 1, false},
+    {"ants_1000", 2000, 1, 1000, 1, false},
+    {"ants_100000", 2000, 1, 100000, 1, false},
+    {"ants_500000", 2000, 1, 500000, 1, true},
+    {"nests_1", 1000, 1, 100, 1, false},
+    {"nests_16", 1000, 16, 100, 1, false},
+    {"nests_255", 1000, 255, 100, 1, true},
+    {"threads_2", 1000, 4, 100, 2, false},
+    {"threads_4", 1000, 4, 100, 4, false},
+    {"threads_8", 1000, 4, 100, 8, true}
+};
+// clang-format on
+
+struct scenario_result {
+    double startup_seconds = 0; // Creating every replica
+    double run_seconds = 0;
+    double ticks_per_second = 0; // Per replica
+    double ns_per_ant_tick = 0;
+    std::uint64_t peak_rss_bytes = 0; // 0 if it couldn't be measured
+};
+
+// Ant counts are sampled at every sync, which is frequent enough for populations that change slowly
+constexpr tick_t sync_interval = 10;
+
+// Returns the process' peak resident set size, in bytes
+std::uint64_t get_peak_rss() {
+#ifdef ANT_SIM_HAS_FORK
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+scenario_result run_scenario(const scenario_t& scenario, tick_t ticks) {
+    simulation_args_t args = {};
+    args.rows = scenario.size;
+    args.columns = scenario.size;
+    args.nest_count = scenario.nest_count;
+    args.ant_count_per_nest = scenario.ant_count_per_nest;
+
+    std::vector<std::uint64_t> seeds(scenario.thread_count);
+
+    for(auto i = 0uz; i < seeds.size(); i++) {
+        seeds[i] = i;
+    }
+
+    scenario_result result;
+
+    auto start = benchmark_clock::now();
+
+    ensemble replicas{args, seeds};
+
+    auto started = benchmark_clock::now();
+
+    auto count_ants = [&] {
+        auto count = 0uz;
+
+        for(auto i = 0uz; i < replicas.size(); i++) {
+            count += replicas[i].get_ants().size();
+        }
+
+        return static_cast<double>(count);
+    };
+
+    // Each interval is counted with the ants alive at its start
+    double ant_ticks = 0;
+    double ants = count_ants();
+    tick_t last_sync = 0;
+
+    replicas.run(ticks, scenario.thread_count, sync_interval, [&](tick_t tick) {
+        ant_ticks += ants * (tick - last_sync);
+        ants = count_ants();
+        last_sync = tick;
+    });
+
+    auto finished = benchmark_clock::now();
+
+    result.startup_seconds = std::chrono::duration<double>{started - start}.count();
+    result.run_seconds = std::chrono::duration<double>{finished - started}.count();
+    result.ticks_per_second = ticks / result.run_seconds;
+    result.ns_per_ant_tick = result.run_seconds * 1e9 / ant_ticks;
+    result.peak_rss_bytes = get_peak_rss();
+
+    return result;
+}
+
+// Runs the scenario in a child process where possible, so that its peak memory isn't hidden by earlier scenarios
+scenario_result run_isolated(const scenario_t& scenario, tick_t ticks) {
+#ifdef ANT_SIM_HAS_FORK
+    int fds[2];
+
+    if(pipe(fds) != 0) throw std::runtime_error{"Error: could not create a pipe"};
+
+    auto child = fork();
+
+    if(child < 0) throw std::runtime_error{"Error: could not start a process for the scenario"};
+
+    if(child == 0) {
+        close(fds[0]);
+
+        auto result = run_scenario(scenario, ticks);
+
+        auto written = write(fds[1], &result, sizeof(result));
+
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+
+    scenario_result result;
+    auto bytes_read = read(fds[0], &result, sizeof(result));
+
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    auto succeeded = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+
+    if(bytes_read != static_cast<ssize_t>(sizeof(result)) || !succeeded) {
+        throw std::runtime_error{std::string{"Error: scenario "} + scenario.name + " failed"};
+    }
+
+    return result;
+#else
+    return run_scenario(scenario, ticks);
+#endif
+}
+
+// Reads the ns_per_ant_tick of each scenario from a report written by write_report
+// Reports have one scenario per line, so no JSON parser is needed
+std::unordered_map<std::string, double> read_baseline(const std::string& path) {
+    std::ifstream file{path};
+
+    if(!file) throw std::runtime_error{"Error: could not open the baseline " + path};
+
+    std::unordered_map<std::string, double> baseline;
+
+    constexpr std::string_view name_key = "\"name\": \"";
+    constexpr std::string_view metric_key = "\"ns_per_ant_tick\": ";
+
+    for(std::string line; std::getline(file, line);) {
+        auto name_start = line.find(name_key);
+        auto metric_start = line.find(metric_key);
+
+        if(name_start == std::string::npos || metric_start == std::string::npos) continue;
+
+        name_start += name_key.size();
+
+        auto name = line.substr(name_start, line.find('"', name_start) - name_start);
+
+        baseline[name] = std::stod(line.substr(metric_start + metric_key.size()));
+    }
+
+    return baseline;
+}
+
+struct report_entry {
+    const scenario_t* scenario;
+    scenario_result result;
+};
+
+void write_report(const std::string& path, tick_t ticks, const std::vector<report_entry>& entries) {
+    std::ofstream file{path};
+
+    if(!file) throw std::runtime_error{"Error: could not open " + path + " to write the report"};
+
+    std::println(file, "{{");
+    std::println(file, "  \"version\": \"{}\",", ant_sim_project::PROJECT_VERSION);
+    std::println(file, "  \"simulation_version\": {},", ant_sim_project::SIMULATION_VERSION);
+    std::println(file, "  \"ticks\": {},", ticks);
+    std::println(file, "  \"scenarios\": [");
+
+    for(auto i = 0uz; i < entries.size(); i++) {
+        const auto& [scenario, result] = entries[i];
+
+        std::println(file,
+                     "    {{\"name\": \"{}\", \"rows\": {}, \"columns\": {}, \"nests\": {}, \"ants_per_nest\": {}, "
+                     "\"threads\": {}, \"startup_seconds\": {}, \"ticks_per_second\": {}, \"ns_per_ant_tick\": {}, "
+                     "\"peak_rss_bytes\": {}}}{}",
+                     scenario->name, scenario->size, scenario->size, scenario->nest_count,
+                     scenario->ant_count_per_nest, scenario->thread_count, result.startup_seconds,
+                     result.ticks_per_second, result.ns_per_ant_tick, result.peak_rss_bytes,
+                     i + 1 < entries.size() ? "," : "");
+    }
+
+    std::println(file, "  ]");
+    std::println(file, "}}");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool full_suite = false;
+    tick_t ticks = 200;
+    std::string output_path = "scaling_report.json";
+    std::optional<std::string> baseline_path;
+    double threshold = 0.1;
+
+    try {
+        for(auto idx = 1; idx < argc; idx++) {
+            std::string_view arg = argv[idx];
+
+            auto has_value = idx + 1 < argc;
+
+            if(arg == "--suite" && has_value) {
+                std::string_view suite = argv[++idx];
+
+                if(suite != "quick" && suite != "full") throw std::invalid_argument{"unknown suite"};
+
+                full_suite = suite == "full";
+            } else if(arg == "--ticks" && has_value) {
+                ticks = static_cast<tick_t>(std::stoul(argv[++idx]));
+            } else if(arg == "--output" && has_value) {
+                output_path = argv[++idx];
+            } else if(arg == "--baseline" && has_value) {
+                baseline_path = argv[++idx];
+            } else if(arg == "--threshold" && has_value) {
+                threshold = std::stod(argv[++idx]);
+            } else {
+                throw std::invalid_argument{"unknown argument"};
+            }
+        }
+    } catch(...) {
+        std::println("Error parsing arguments");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        std::println("Scaling,scenario,rows,columns,nests,ants_per_nest,threads,startup_seconds,ticks_per_second,"
+                     "ns_per_ant_tick,peak_rss_bytes");
+
+        std::vector<report_entry> entries;
+
+        for(const auto& scenario : scenarios) {
+            if(scenario.full_only && !full_suite) continue;
+
+            auto result = run_isolated(scenario, ticks);
+
+            std::println("Scaling,{},{},{},{},{},{},{:.3f},{:.1f},{:.1f},{}", scenario.name, scenario.size,
+                         scenario.size, scenario.nest_count, scenario.ant_count_per_nest, scenario.thread_count,
+                         result.startup_seconds, result.ticks_per_second, result.ns_per_ant_tick,
+                         result.peak_rss_bytes);
+
+            entries.push_back({&scenario, result});
+        }
+
+        write_report(output_path, ticks, entries);
+
+        if(!baseline_path) return EXIT_SUCCESS;
+
+        auto baseline = read_baseline(*baseline_path);
+
+        auto regressions = 0uz;
+
+        for(const auto& [scenario, result] : entries) {
+            auto it = baseline.find(scenario->name);
+
+            if(it == baseline.end()) continue;
+
+            auto change = result.ns_per_ant_tick / it->second - 1;
+
+            if(change > threshold) {
+                std::println("Regression,{},ns_per_ant_tick,{:.1f},{:.1f},{:+.1f}%", scenario->name, it->second,
+                             result.ns_per_ant_tick, change * 100);
+                regressions++;
+            }
+        }
+
+        std::println("Regressions,{}", regressions);
+
+        return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch(const std::exception& e) {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -8,11 +8,13 @@ namespace ant_sim {
 
 struct tile;
 class simulation;
+struct tick_counters;
 
 class ant {
     std::optional<point<>> calculate_next_location(simulation& world);
 
-    float calculate_tile_weight(const tile& tile, simulation& world) const noexcept;
+    float calculate_tile_weight(const tile& tile, bool has_food, float type1_strength, float type2_strength,
+                                simulation& world) const noexcept;
 
   public:
     nest_id_t nest_id;
@@ -29,8 +31,9 @@ class ant {
     float hunger;
     food_supply_t food_in_inventory;
 
-    void tick(simulation& sim);
-    void move(simulation& sim, point<> new_location);
+    // Changes to the simulation's statistics are added to counters, rather than to the simulation itself
+    void tick(simulation& sim, tick_counters& counters);
+    void move(simulation& sim, point<> new_location, tick_counters& counters);
 };
 
 } // namespace ant_sim
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ant_sim {
+
+// The kind of pages backing an arena
+enum class page_kind : std::uint8_t {
+    normal,           // Regular pages, usually 4 KiB
+    transparent_huge, // Regular pages, with the kernel asked to back them with transparent huge pages
+    explicit_huge,    // Pages from the reserved huge page pool (MAP_HUGETLB)
+    heap              // Memory from std::calloc, used when mapping memory directly isn't supported
+};
+
+struct arena_options {
+    // Try to use pages from the reserved huge page pool first
+    // This only succeeds if huge pages have been reserved, for example through /proc/sys/vm/nr_hugepages
+    bool explicit_huge_pages = false;
+
+    // Ask the kernel to back the arena with transparent huge pages
+    bool transparent_huge_pages = true;
+
+    // If nonzero, every page is committed up front by this many threads, each touching a contiguous share
+    // This moves the page faults from the run to its start, where they are spread over several cores
+    // If zero, each page is committed when it is first written to, usually by the simulation thread
+    unsigned first_touch_threads = 0;
+};
+
+struct arena_stats {
+    std::size_t size = 0;            // Bytes reserved
+    std::size_t resident_bytes = 0;  // Bytes currently backed by physical memory
+    std::size_t huge_page_bytes = 0; // Resident bytes backed by huge pages, transparent or explicit
+    page_kind kind = page_kind::normal;
+};
+
+[[nodiscard]] const char* to_string(page_kind kind) noexcept;
+
+// A single zero-filled block of memory mapped directly from the OS
+// Pages are only committed once they are touched, so the cost of a large arena is proportional to what is used
+class arena {
+    std::byte* base = nullptr;
+    std::size_t mapped_size = 0; // May be rounded up from the requested size
+    std::size_t requested_size = 0;
+    page_kind kind = page_kind::normal;
+
+    void release() noexcept;
+
+  public:
+    arena() noexcept = default;
+    arena(std::size_t size, const arena_options& options);
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    arena(arena&& other) noexcept;
+    arena& operator=(arena&& other) noexcept;
+
+    ~arena();
+
+    [[nodiscard]] std::byte* data() const noexcept { return base; }
+    [[nodiscard]] std::size_t size() const noexcept { return requested_size; }
+    [[nodiscard]] page_kind get_page_kind() const noexcept { return kind; }
+
+    // Reads the residency of the arena's pages from the OS
+    // Only the reserved size is known on platforms other than Linux
+    [[nodiscard]] arena_stats stats() const;
+};
+
+} // namespace ant_sim
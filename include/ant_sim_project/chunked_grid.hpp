@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "arena.hpp"
+
+#include <experimental/mdspan>
+
+namespace ant_sim {
+
+namespace stdex = std::experimental;
+
+// The width and height of a chunk, in elements
+constexpr std::size_t chunk_size = 64;
+constexpr std::size_t chunk_area = chunk_size * chunk_size;
+
+// Maps (y, x) to an offset in a grid made of chunk_size x chunk_size chunks
+// Chunks are stored one after another in row-major order, and so are the elements within each chunk
+// The offset divided by chunk_area is the chunk's index, and the remainder is the element's index within the chunk
+struct layout_chunked {
+    template <typename Extents>
+    class mapping {
+        static_assert(Extents::rank() == 2, "layout_chunked only supports 2 dimensional grids");
+
+      public:
+        using extents_type = Extents;
+        using index_type = typename extents_type::index_type;
+        using size_type = typename extents_type::size_type;
+        using rank_type = typename extents_type::rank_type;
+        using layout_type = layout_chunked;
+
+      private:
+        extents_type grid_extents;
+        index_type chunks_per_row = 0;
+
+      public:
+        constexpr mapping() noexcept = default;
+        constexpr explicit mapping(const extents_type& extents) noexcept
+            : grid_extents{extents}, chunks_per_row{(extents.extent(1) + chunk_size - 1) / chunk_size} {}
+
+        [[nodiscard]] constexpr const extents_type& extents() const noexcept { return grid_extents; }
+
+        [[nodiscard]] constexpr index_type operator()(index_type y, index_type x) const noexcept {
+            auto chunk = y / chunk_size * chunks_per_row + x / chunk_size;
+
+            return chunk * chunk_area + y % chunk_size * chunk_size + x % chunk_size;
+        }
+
+        [[nodiscard]] constexpr index_type required_span_size() const noexcept {
+            auto chunk_rows = (grid_extents.extent(0) + chunk_size - 1) / chunk_size;
+
+            return chunk_rows * chunks_per_row * chunk_area;
+        }
+
+        // Partially filled chunks at the right and bottom edges leave gaps, so the mapping isn't exhaustive
+        [[nodiscard]] static constexpr bool is_always_unique() noexcept { return true; }
+        [[nodiscard]] static constexpr bool is_always_exhaustive() noexcept { return false; }
+        [[nodiscard]] static constexpr bool is_always_strided() noexcept { return false; }
+
+        [[nodiscard]] static constexpr bool is_unique() noexcept { return true; }
+        [[nodiscard]] constexpr bool is_exhaustive() const noexcept {
+            return grid_extents.extent(0) % chunk_size == 0 && grid_extents.extent(1) % chunk_size == 0;
+        }
+        [[nodiscard]] static constexpr bool is_strided() noexcept { return false; }
+
+        friend constexpr bool operator==(const mapping& lhs, const mapping& rhs) noexcept {
+            return lhs.grid_extents == rhs.grid_extents;
+        }
+    };
+};
+
+// Owns the chunks of a chunked_grid
+// Chunks are allocated the first time they are written to
+// Reading from a chunk that was never written to returns elements from a shared chunk of zeroes
+// T must be valid when all of its bytes are zero, and must not need its constructor or destructor to run
+template <typename T>
+    requires std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+class chunk_table {
+    struct deleter {
+        void operator()(T* pointer) const noexcept { std::free(pointer); }
+    };
+
+    // Not const, so that it is placed in zero-initialized memory instead of taking up space in the executable
+    // It is never handed out as non-const, so it is never written to
+    static inline T zero_chunk[chunk_area];
+
+    std::vector<std::unique_ptr<T[], deleter>> chunks;
+    std::size_t allocated_count = 0;
+
+    T* allocate(std::size_t chunk) {
+        chunks[chunk].reset(static_cast<T*>(std::calloc(chunk_area, sizeof(T))));
+
+        if(!chunks[chunk]) throw std::bad_alloc{};
+
+        allocated_count++;
+
+        return chunks[chunk].get();
+    }
+
+  public:
+    chunk_table() noexcept = default;
+    explicit chunk_table(std::size_t chunk_count) : chunks(chunk_count) {}
+
+    // Returns the chunk with the given index, allocating it if necessary
+    [[nodiscard]] T* chunk_for_write(std::size_t chunk) {
+        auto* pointer = chunks[chunk].get();
+
+        if(!pointer) [[unlikely]] {
+            pointer = allocate(chunk);
+        }
+
+        return pointer;
+    }
+
+    // Returns the chunk with the given index, or the shared chunk of zeroes if it hasn't been allocated
+    [[nodiscard]] const T* chunk_for_read(std::size_t chunk) const noexcept {
+        auto* pointer = chunks[chunk].get();
+
+        return pointer ? pointer : zero_chunk;
+    }
+
+    [[nodiscard]] bool is_allocated(std::size_t chunk) const noexcept { return chunks[chunk] != nullptr; }
+
+    // Calls f on every element of every allocated chunk, including elements past the edges of the grid
+    void for_each_allocated(auto&& f) {
+        for(auto& chunk : chunks) {
+            if(!chunk) continue;
+
+            for(auto i = 0uz; i < chunk_area; i++) {
+                f(chunk[i]);
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t chunk_count() const noexcept { return chunks.size(); }
+    [[nodiscard]] std::size_t allocated_chunk_count() const noexcept { return allocated_count; }
+
+    // The number of bytes used by the table and all allocated chunks
+    [[nodiscard]] std::size_t memory_usage() const noexcept {
+        return chunks.capacity() * sizeof(chunks[0]) + allocated_count * chunk_area * sizeof(T);
+    }
+};
+
+// An mdspan accessor that looks up elements in a chunk_table
+// Offsets are produced by layout_chunked
+// Accessing a non-const element allocates its chunk; accessing a const element never allocates
+template <typename T>
+struct chunked_accessor {
+    using element_type = T;
+    using reference = T&;
+    using offset_policy = chunked_accessor;
+
+    using table_type = std::conditional_t<std::is_const_v<T>, const chunk_table<std::remove_const_t<T>>,
+                                          chunk_table<std::remove_const_t<T>>>;
+
+    struct data_handle_type {
+        table_type* table = nullptr;
+        std::size_t base = 0;
+    };
+
+    constexpr chunked_accessor() noexcept = default;
+
+    [[nodiscard]] reference access(const data_handle_type& handle, std::size_t i) const {
+        auto offset = handle.base + i;
+
+        if constexpr(std::is_const_v<T>) {
+            return handle.table->chunk_for_read(offset / chunk_area)[offset % chunk_area];
+        } else {
+            return handle.table->chunk_for_write(offset / chunk_area)[offset % chunk_area];
+        }
+    }
+
+    [[nodiscard]] data_handle_type offset(const data_handle_type& handle, std::size_t i) const noexcept {
+        return {handle.table, handle.base + i};
+    }
+};
+
+// A rows x columns grid stored as chunk_size x chunk_size chunks, allocated the first time they are written to
+// Memory usage is proportional to the area that has been written to, rather than to the size of the grid
+template <typename T>
+class chunked_grid {
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+
+    chunk_table<T> table;
+
+    using extents_type = stdex::dextents<std::size_t, 2>;
+
+  public:
+    using span_type = stdex::mdspan<T, extents_type, layout_chunked, chunked_accessor<T>>;
+    using const_span_type = stdex::mdspan<const T, extents_type, layout_chunked, chunked_accessor<const T>>;
+
+    chunked_grid() noexcept = default;
+
+    // options is unused, as chunks are allocated individually
+    chunked_grid(std::size_t rows, std::size_t columns, [[maybe_unused]] const arena_options& options = {})
+        : rows{rows}, columns{columns},
+          table{((rows + chunk_size - 1) / chunk_size) * ((columns + chunk_size - 1) / chunk_size)} {}
+
+    // Non-const accesses through the returned span allocate chunks, so use the const overload for reading
+    [[nodiscard]] span_type span() noexcept {
+        return span_type{{&table, 0}, typename span_type::mapping_type{extents_type{rows, columns}}, {}};
+    }
+
+    [[nodiscard]] const_span_type span() const noexcept {
+        return const_span_type{{&table, 0}, typename const_span_type::mapping_type{extents_type{rows, columns}}, {}};
+    }
+
+    // Calls f on every element of every allocated chunk
+    // Unallocated chunks are skipped, as all of their elements are zero
+    void for_each(auto&& f) { table.for_each_allocated(f); }
+
+    [[nodiscard]] const chunk_table<T>& get_chunk_table() const noexcept { return table; }
+
+    [[nodiscard]] arena_stats memory_stats() const noexcept {
+        auto bytes = table.memory_usage();
+
+        return {.size = bytes, .resident_bytes = bytes, .kind = page_kind::heap};
+    }
+
+    // The bytes used by a grid of the given size once every chunk has been allocated
+    [[nodiscard]] static std::size_t bytes_required(std::size_t rows, std::size_t columns) noexcept {
+        auto chunk_count = ((rows + chunk_size - 1) / chunk_size) * ((columns + chunk_size - 1) / chunk_size);
+
+        return chunk_count * (sizeof(void*) + chunk_area * sizeof(T));
+    }
+};
+
+} // namespace ant_sim
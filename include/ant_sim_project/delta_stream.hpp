@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// Delta streams are binary files describing the tiles changed by each tick, so that tools can follow a run with work
+// proportional to the number of ants instead of to the size of the world
+// Every value is little endian, and floats are IEEE 754 single precision
+//
+//   Header: the bytes "ANTDELTA", then u32 version, u64 rows, u64 columns, then a Tick record of the starting state
+//   Tick:   u32 tick count after the tick, u32 number of changed tiles, then each tile
+//   Tile:   u32 x, u32 y, u8 flags
+//           u8 nest id if the tile has a nest, u32 ant id if it has an ant, f32 food supply if it has food
+//           u8 number of pheromone entries, then each entry
+//   Entry:  u8 nest id, then for each pheromone type f32 strength and u32 tick it was last updated at
+//
+// A tile's record holds everything stored in it, so it replaces whatever was known about the tile before
+// Tiles without a record are empty, and a tile may appear more than once in the starting state
+// Strengths are as stored, and fade from the tick they were last updated at like they do in the simulation
+class delta_writer {
+    std::ofstream file;
+
+    // The current tick's record, so that it is written with a single call
+    std::vector<std::uint8_t> buffer;
+
+    std::size_t ticks_written = 0; // Not counting the starting state
+    std::size_t bytes_written = 0;
+
+    void write_record(const simulation& sim, std::span<const point<>> locations);
+
+  public:
+    // Writes the header, and the tiles holding nests, food or ants
+    // Throws std::runtime_error if the file can't be opened
+    delta_writer(const std::filesystem::path& path, const simulation& sim);
+
+    // Writes the tiles changed by the tick that just ran
+    void write_tick(const simulation& sim);
+
+    [[nodiscard]] std::size_t get_ticks_written() const noexcept { return ticks_written; }
+    [[nodiscard]] std::size_t get_bytes_written() const noexcept { return bytes_written; }
+};
+
+} // namespace ant_sim
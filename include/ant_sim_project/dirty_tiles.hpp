@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "types.hpp"
+#include "zeroed_array.hpp"
+
+namespace ant_sim {
+
+// The set of tiles changed during a tick
+// A bitmap with one bit per tile keeps each tile from being listed twice, and the list of changed tiles lets them be
+// iterated and cleared in time proportional to the number of changes, rather than to the size of the world
+// The bitmap is a zeroed_array, so only the pages covering tiles that have changed are ever committed
+class dirty_tiles {
+    static constexpr std::size_t bits_per_word = 64;
+
+    std::size_t columns = 0;
+
+    zeroed_array<std::uint64_t> bits;
+
+    // In the order they were first changed
+    std::vector<point<>> changed;
+
+  public:
+    dirty_tiles() noexcept = default;
+
+    dirty_tiles(std::size_t rows, std::size_t columns)
+        : columns{columns}, bits{(rows * columns + bits_per_word - 1) / bits_per_word} {}
+
+    // Records that the tile at location changed
+    void mark(point<> location) {
+        auto index = location.y * columns + location.x;
+
+        auto& word = bits[index / bits_per_word];
+        auto bit = std::uint64_t{1} << (index % bits_per_word);
+
+        if(word & bit) return;
+
+        word |= bit;
+        changed.push_back(location);
+    }
+
+    [[nodiscard]] bool contains(point<> location) const noexcept {
+        auto index = location.y * columns + location.x;
+
+        return bits[index / bits_per_word] & (std::uint64_t{1} << (index % bits_per_word));
+    }
+
+    // Forgets every change, only touching the words of the tiles that changed
+    void clear() noexcept {
+        for(auto [x, y] : changed) {
+            bits[(y * columns + x) / bits_per_word] = 0;
+        }
+
+        changed.clear();
+    }
+
+    // The changed tiles, each listed once
+    [[nodiscard]] std::span<const point<>> get_tiles() const noexcept { return changed; }
+
+    [[nodiscard]] std::size_t size() const noexcept { return changed.size(); }
+    [[nodiscard]] bool empty() const noexcept { return changed.empty(); }
+
+    // The bytes committed for the bitmap, and reserved for the list of changes
+    [[nodiscard]] std::size_t memory_usage() const {
+        return bits.memory_stats().resident_bytes + changed.capacity() * sizeof(point<>);
+    }
+};
+
+} // namespace ant_sim
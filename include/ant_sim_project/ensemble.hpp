@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// Runs replicas of the same configuration that differ only in their seeds, stepping them in lockstep
+// Replicas are split between a pool of threads, which wait for each other every sync_interval ticks
+// Between syncs every replica has reached the same tick, so results can be compared or aggregated across replicas
+class ensemble {
+    std::vector<std::unique_ptr<simulation>> replicas;
+
+  public:
+    // Creates one replica per seed
+    // Replicas don't log ticks, births, deaths or state changes, as the logs of different replicas would interleave
+    ensemble(simulation_args_t args, std::span<const std::uint64_t> seeds);
+
+    // Ticks every replica until it reaches max_ticks or stops
+    // on_sync is called by a single thread at each sync, with the tick every running replica has reached
+    void run(tick_t max_ticks, unsigned thread_count, tick_t sync_interval,
+             const std::function<void(tick_t)>& on_sync = {});
+
+    [[nodiscard]] std::size_t size() const noexcept { return replicas.size(); }
+
+    [[nodiscard]] simulation& operator[](std::size_t i) noexcept { return *replicas[i]; }
+    [[nodiscard]] const simulation& operator[](std::size_t i) const noexcept { return *replicas[i]; }
+};
+
+} // namespace ant_sim
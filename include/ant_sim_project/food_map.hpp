@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "memory_usage.hpp"
+#include "types.hpp"
+
+namespace ant_sim {
+
+// The food of a chunked world, kept outside of its grids
+// Generated food is spread across the whole world, so storing it in the tiles would allocate every chunk
+// A food source keeps its entry once it has been emptied, as it is resupplied every tick
+class food_map {
+    std::size_t columns = 0;
+
+    std::unordered_map<std::uint64_t, food_supply_t> supplies;
+
+    [[nodiscard]] std::uint64_t key(point<> location) const noexcept { return location.y * columns + location.x; }
+
+  public:
+    food_map() noexcept = default;
+
+    explicit food_map(std::size_t columns) noexcept : columns{columns} {}
+
+    void reserve(std::size_t food_source_count) { supplies.reserve(food_source_count); }
+
+    // Returns the food on the tile at location, which is 0 if it isn't a food source
+    [[nodiscard]] food_supply_t get(point<> location) const noexcept {
+        auto it = supplies.find(key(location));
+
+        return it != supplies.end() ? it->second : 0;
+    }
+
+    void set(point<> location, food_supply_t supply) { supplies[key(location)] = supply; }
+
+    [[nodiscard]] std::size_t memory_usage() const noexcept { return unordered_map_bytes(supplies); }
+
+    // The bytes used by a map reserved for food_source_count food sources, which leaves a bucket for each of them
+    [[nodiscard]] static std::size_t bytes_required(std::size_t food_source_count) noexcept {
+        return unordered_map_bytes<decltype(supplies)>(food_source_count, food_source_count);
+    }
+};
+
+} // namespace ant_sim
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "image_writer.hpp"
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+struct frame_export_options {
+    std::filesystem::path directory;
+    tick_t interval = 100; // A frame is written every this many ticks
+    image_format format = image_format::png;
+
+    // The pheromone trail shown, like the one picked in the GUI
+    nest_id_t pheromone_nest_id = 0;
+    std::size_t pheromone_type = 0;
+
+    unsigned thread_count = 0; // Threads used to rasterise each frame, 0 to use every hardware thread
+};
+
+// Writes images of the world while the simulation runs, without a window
+// Frames are drawn with the same colours as the window, at one pixel per tile
+//
+// The tick thread only copies what the colours depend on into a snapshot
+// Rasterising and encoding happen on a background thread, which splits each frame into bands of rows
+// If the background thread falls behind by more than one frame, frames are dropped instead of holding up the simulation
+class frame_exporter {
+    // Only the state each tile's colour depends on
+    struct snapshot {
+        std::size_t rows = 0;
+        std::size_t columns = 0;
+        tick_t tick = 0;
+        food_supply_t max_food_supply = 0;
+        float falloff_rate = 0;
+
+        std::vector<tile> tiles;
+        std::vector<food_supply_t> food_supply;
+        std::vector<pheromone_strength_t> pheromone_strength;
+        std::vector<tick_t> pheromone_last_updated;
+    };
+
+    frame_export_options options;
+
+    // Each snapshot is only ever owned by one of the tick thread, the queue or the background thread
+    // They are swapped rather than copied, so their memory is reused from frame to frame
+    snapshot capturing;
+    snapshot queued;
+    snapshot writing;
+
+    std::vector<std::uint8_t> pixels;
+
+    std::mutex mutex;
+    std::condition_variable_any frame_queued;
+    bool has_queued_frame = false;
+
+    std::size_t frames_written = 0;
+    std::size_t frames_dropped = 0;
+
+    // Declared last, so that it's stopped and joined before anything it uses is destroyed
+    std::jthread worker;
+
+    void capture(const simulation& sim);
+    void rasterise();
+    void run(const std::stop_token& stop_token);
+
+  public:
+    // Throws std::runtime_error if the directory can't be created
+    explicit frame_exporter(frame_export_options export_options);
+
+    frame_exporter(const frame_exporter&) = delete;
+    frame_exporter& operator=(const frame_exporter&) = delete;
+
+    ~frame_exporter();
+
+    // Queues a frame if one is due at the simulation's current tick
+    // Must be called after every tick, while the simulation is locked
+    void after_tick(const simulation& sim);
+
+    // Writes any frame still queued, then stops the background thread
+    // No more frames are written after this returns
+    void finish();
+
+    [[nodiscard]] std::size_t get_frames_written();
+    [[nodiscard]] std::size_t get_frames_dropped();
+};
+
+} // namespace ant_sim
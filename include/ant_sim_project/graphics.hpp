@@ -16,7 +16,7 @@ class world_drawable : public sf::Drawable {
     // The amount to zoom in or out by
     float zoom_increment = 0.1f;
 
-    void draw_info(simulation& locked_sim) const;
+    void draw_info(const simulation& locked_sim) const;
 
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "arena.hpp"
+#include "zeroed_array.hpp"
+#include "chunked_grid.hpp"
+#include "morton_layout.hpp"
+#include "types.hpp"
+
+#include <experimental/mdspan>
+
+namespace ant_sim {
+
+namespace stdex = std::experimental;
+
+// A rows x columns grid stored as a single array, with elements ordered by Layout
+// Every element is reserved up front, although pages are only committed once they are written to
+template <typename T, typename Layout = stdex::layout_right>
+class dense_grid {
+    using extents_type = stdex::dextents<std::size_t, 2>;
+    using mapping_type = typename Layout::template mapping<extents_type>;
+
+    mapping_type mapping;
+
+    zeroed_array<T> elements;
+
+  public:
+    using span_type = stdex::mdspan<T, extents_type, Layout>;
+    using const_span_type = stdex::mdspan<const T, extents_type, Layout>;
+
+    dense_grid() noexcept = default;
+
+    dense_grid(std::size_t rows, std::size_t columns, const arena_options& options = {})
+        : mapping{extents_type{rows, columns}}, elements(mapping.required_span_size(), options) {}
+
+    [[nodiscard]] span_type span() noexcept { return span_type{elements.data(), mapping}; }
+    [[nodiscard]] const_span_type span() const noexcept { return const_span_type{elements.data(), mapping}; }
+
+    // Calls f on every element, including any padding the layout leaves past the edges of the grid
+    void for_each(auto&& f) {
+        for(auto i = 0uz; i < elements.size(); i++) {
+            f(elements[i]);
+        }
+    }
+
+    [[nodiscard]] arena_stats memory_stats() const { return elements.memory_stats(); }
+
+    // The bytes reserved for a grid of the given size, all of which are committed once every page is written to
+    [[nodiscard]] static std::size_t bytes_required(std::size_t rows, std::size_t columns) noexcept {
+        return mapping_type{extents_type{rows, columns}}.required_span_size() * sizeof(T);
+    }
+};
+
+// The directions of an element's 8 neighbours, as x and y offsets
+// The order decides which neighbour ants pick when weights tie, and the order random numbers are drawn in
+// clang-format off
+inline constexpr point<std::ptrdiff_t> neighbor_directions[] = {
+    {-1, -1}, {-1, 0}, {-1, 1},
+    {1, -1}, {1, 0}, {1, 1},
+    {0, -1}, {0, 1}
+};
+// clang-format on
+
+constexpr std::size_t neighbor_count = std::size(neighbor_directions);
+
+// A rows x columns grid in row-major order, surrounded by a one element border
+// span() only covers the interior, so the border is invisible to everything that doesn't ask for it
+// Every interior element's neighbours are at fixed offsets from it, so they can be visited without bounds checks
+template <typename T>
+class padded_grid {
+    using extents_type = stdex::dextents<std::size_t, 2>;
+    using mapping_type = stdex::layout_stride::mapping<extents_type>;
+
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+
+    // (rows + 2) x (columns + 2), including the border
+    dense_grid<T> elements;
+
+    std::array<std::ptrdiff_t, neighbor_count> neighbor_offsets{};
+
+    [[nodiscard]] std::size_t row_stride() const noexcept { return columns + 2; }
+
+    [[nodiscard]] mapping_type interior_mapping() const noexcept {
+        return {extents_type{rows, columns}, std::array<std::size_t, 2>{row_stride(), 1}};
+    }
+
+    // The offset of the first interior element, one row down and one column in
+    [[nodiscard]] std::size_t interior_offset() const noexcept { return row_stride() + 1; }
+
+  public:
+    using span_type = stdex::mdspan<T, extents_type, stdex::layout_stride>;
+    using const_span_type = stdex::mdspan<const T, extents_type, stdex::layout_stride>;
+
+    padded_grid() noexcept = default;
+
+    // The border is zeroed like the rest of the grid, until fill_border is called
+    padded_grid(std::size_t rows, std::size_t columns, const arena_options& options = {})
+        : rows{rows}, columns{columns}, elements{rows + 2, columns + 2, options} {
+        auto stride = static_cast<std::ptrdiff_t>(row_stride());
+
+        for(auto i = 0uz; i < neighbor_count; i++) {
+            neighbor_offsets[i] = neighbor_directions[i].y * stride + neighbor_directions[i].x;
+        }
+    }
+
+    // Sets every element of the border to border_value
+    // This commits the pages holding each row's first and last elements
+    void fill_border(const T& border_value) {
+        auto all = elements.span();
+
+        for(auto x = 0uz; x < columns + 2; x++) {
+            all[0, x] = border_value;
+            all[rows + 1, x] = border_value;
+        }
+
+        for(auto y = 1uz; y <= rows; y++) {
+            all[y, 0] = border_value;
+            all[y, columns + 1] = border_value;
+        }
+    }
+
+    [[nodiscard]] span_type span() noexcept {
+        return span_type{elements.span().data_handle() + interior_offset(), interior_mapping()};
+    }
+
+    [[nodiscard]] const_span_type span() const noexcept {
+        return const_span_type{elements.span().data_handle() + interior_offset(), interior_mapping()};
+    }
+
+    // The offsets from an interior element to each of its neighbours, in the order of neighbor_directions
+    [[nodiscard]] const std::array<std::ptrdiff_t, neighbor_count>& get_neighbor_offsets() const noexcept {
+        return neighbor_offsets;
+    }
+
+    // Calls f on every interior element, so that the border can't be overwritten
+    void for_each(auto&& f) {
+        auto interior = span();
+
+        for(auto y = 0uz; y < rows; y++) {
+            for(auto x = 0uz; x < columns; x++) {
+                f(interior[y, x]);
+            }
+        }
+    }
+
+    [[nodiscard]] arena_stats memory_stats() const { return elements.memory_stats(); }
+
+    [[nodiscard]] static std::size_t bytes_required(std::size_t rows, std::size_t columns) noexcept {
+        return dense_grid<T>::bytes_required(rows + 2, columns + 2);
+    }
+};
+
+// The grid type used to store the world
+// Building with ANT_SIM_CHUNKED_WORLD stores the world in lazily allocated chunks, for huge but mostly empty worlds
+// Building with ANT_SIM_MORTON_LAYOUT stores the world in Z-order blocks, so neighbouring tiles are close in memory
+#ifdef ANT_SIM_CHUNKED_WORLD
+template <typename T>
+using world_grid = chunked_grid<T>;
+#elif defined(ANT_SIM_MORTON_LAYOUT)
+template <typename T>
+using world_grid = dense_grid<T, layout_morton>;
+#else
+template <typename T>
+using world_grid = dense_grid<T>;
+#endif
+
+// The grid type used for the tiles ants check before moving
+// Row-major worlds give the tiles a border of full tiles, so ants can visit their neighbours without bounds checks
+// Chunked and Morton worlds keep their layout, as neighbours aren't at fixed offsets in them
+#if !defined(ANT_SIM_CHUNKED_WORLD) && !defined(ANT_SIM_MORTON_LAYOUT)
+#define ANT_SIM_TILE_BORDER
+#endif
+
+#ifdef ANT_SIM_TILE_BORDER
+template <typename T>
+using bordered_world_grid = padded_grid<T>;
+#else
+template <typename T>
+using bordered_world_grid = world_grid<T>;
+#endif
+
+} // namespace ant_sim
@@ -15,6 +15,16 @@ class gui {
     simulation_mutex* sim;
     graphics::world_drawable* world_drawable;
 
+    // Reused every frame, so that reading the history doesn't allocate
+    mutable stats_history::snapshot history;
+
+    void draw_history() const;
+
+    // Measuring memory reads from the OS, so it's only refreshed every memory_refresh_interval
+    mutable memory_usage memory;
+    mutable sf::Clock memory_clock;
+    mutable bool memory_measured = false;
+
   public:
     gui(sf::RenderWindow& window, simulation_mutex& sim, graphics::world_drawable& world_drawable);
 
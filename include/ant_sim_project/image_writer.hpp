@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace ant_sim {
+
+enum class image_format { ppm, png };
+
+[[nodiscard]] const char* to_string(image_format format) noexcept;
+
+// Writes an 8 bit RGB image, with pixels stored row by row from the top left
+// PPM is the fastest to write, while PNG is understood by more tools
+// PNGs are written with uncompressed deflate blocks, so no compression library is needed
+// Throws std::runtime_error if the file can't be written
+void write_image(const std::filesystem::path& path, image_format format, std::size_t width, std::size_t height,
+                 std::span<const std::uint8_t> pixels);
+
+} // namespace ant_sim
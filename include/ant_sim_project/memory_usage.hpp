@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace ant_sim {
+
+// Bytes used by each part of a simulation
+struct memory_usage {
+    std::size_t tiles = 0;        // The tile and contents grids, including pheromones
+    std::size_t ants = 0;         // The ant vector, at its capacity
+    std::size_t food_sources = 0; // Their locations, and the food map of a chunked world
+    std::size_t nests = 0;
+    std::size_t new_ants = 0;     // Ants born this tick, waiting to be added
+    std::size_t history = 0;      // The statistics history and its per-tick buffers
+
+    [[nodiscard]] std::size_t total() const noexcept {
+        return tiles + ants + food_sources + nests + new_ants + history;
+    }
+};
+
+struct memory_component {
+    const char* name;
+    std::size_t memory_usage::* member;
+};
+
+// clang-format off
+inline constexpr memory_component memory_components[] = {
+    {"tiles", &memory_usage::tiles},
+    {"ants", &memory_usage::ants},
+    {"food_sources", &memory_usage::food_sources},
+    {"nests", &memory_usage::nests},
+    {"new_ants", &memory_usage::new_ants},
+    {"history", &memory_usage::history}
+};
+// clang-format on
+
+// Heap allocations are rounded up to at least this, so nodes smaller than it still take this much
+constexpr std::size_t allocation_granularity = alignof(std::max_align_t);
+
+[[nodiscard]] constexpr std::size_t round_up_allocation(std::size_t bytes) noexcept {
+    return (bytes + allocation_granularity - 1) / allocation_granularity * allocation_granularity;
+}
+
+template <typename T>
+[[nodiscard]] constexpr std::size_t vector_bytes(std::size_t capacity) noexcept {
+    return capacity * sizeof(T);
+}
+
+template <typename T>
+[[nodiscard]] std::size_t vector_bytes(const std::vector<T>& vector) noexcept {
+    return vector_bytes<T>(vector.capacity());
+}
+
+// The standard library doesn't expose the size of an unordered_map's nodes
+// This assumes the usual layout of a next pointer followed by the value, without a cached hash
+template <typename Map>
+[[nodiscard]] constexpr std::size_t unordered_map_bytes(std::size_t size, std::size_t bucket_count) noexcept {
+    auto node_bytes = round_up_allocation(sizeof(void*) + sizeof(typename Map::value_type));
+
+    return bucket_count * sizeof(void*) + size * node_bytes;
+}
+
+template <typename Key, typename T>
+[[nodiscard]] std::size_t unordered_map_bytes(const std::unordered_map<Key, T>& map) noexcept {
+    return unordered_map_bytes<std::unordered_map<Key, T>>(map.size(), map.bucket_count());
+}
+
+} // namespace ant_sim
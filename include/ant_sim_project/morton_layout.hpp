@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <experimental/mdspan>
+
+namespace ant_sim {
+
+// The width and height of a block in layout_morton, in elements
+// Must be a power of two
+constexpr std::size_t morton_block_size = 32;
+constexpr std::size_t morton_block_area = morton_block_size * morton_block_size;
+
+// Spreads the bits of an index within a block apart, leaving a zero bit between each of them
+// Interleaving the spread bits of y and x gives the element's Morton (Z-order) index within the block
+constexpr auto morton_spread_table = [] {
+    std::array<std::uint16_t, morton_block_size> table{};
+
+    for(auto i = 0uz; i < morton_block_size; i++) {
+        auto spread = 0uz;
+
+        for(auto bit = 0uz; (1uz << bit) < morton_block_size; bit++) {
+            if(i & (1uz << bit)) spread |= 1uz << (bit * 2);
+        }
+
+        table[i] = static_cast<std::uint16_t>(spread);
+    }
+
+    return table;
+}();
+
+// Interleaves the bits of x and y, so that sorting points by the result orders them along a Z-order curve
+// Points that are close together along the curve are close together in the world, and in either layout of it
+[[nodiscard]] constexpr std::uint64_t morton_key(std::uint32_t x, std::uint32_t y) noexcept {
+    auto spread = [](std::uint64_t value) {
+        value = (value | value << 16) & 0x0000ffff0000ffff;
+        value = (value | value << 8) & 0x00ff00ff00ff00ff;
+        value = (value | value << 4) & 0x0f0f0f0f0f0f0f0f;
+        value = (value | value << 2) & 0x3333333333333333;
+        value = (value | value << 1) & 0x5555555555555555;
+
+        return value;
+    };
+
+    return spread(x) | spread(y) << 1;
+}
+
+// Maps (y, x) to an offset in a grid made of morton_block_size x morton_block_size blocks
+// Blocks are stored one after another in row-major order, and the elements within each block in Z-order
+// This keeps the 3x3 neighbourhood of most tiles within a few cache lines, instead of spreading it over three rows
+struct layout_morton {
+    template <typename Extents>
+    class mapping {
+        static_assert(Extents::rank() == 2, "layout_morton only supports 2 dimensional grids");
+        static_assert((morton_block_size & (morton_block_size - 1)) == 0, "morton_block_size must be a power of two");
+
+      public:
+        using extents_type = Extents;
+        using index_type = typename extents_type::index_type;
+        using size_type = typename extents_type::size_type;
+        using rank_type = typename extents_type::rank_type;
+        using layout_type = layout_morton;
+
+      private:
+        extents_type grid_extents;
+        index_type blocks_per_row = 0;
+
+      public:
+        constexpr mapping() noexcept = default;
+        constexpr explicit mapping(const extents_type& extents) noexcept
+            : grid_extents{extents},
+              blocks_per_row{(extents.extent(1) + morton_block_size - 1) / morton_block_size} {}
+
+        [[nodiscard]] constexpr const extents_type& extents() const noexcept { return grid_extents; }
+
+        [[nodiscard]] constexpr index_type operator()(index_type y, index_type x) const noexcept {
+            auto block = y / morton_block_size * blocks_per_row + x / morton_block_size;
+
+            auto within_block = static_cast<index_type>(morton_spread_table[x % morton_block_size]) |
+                                static_cast<index_type>(morton_spread_table[y % morton_block_size]) << 1;
+
+            return block * morton_block_area + within_block;
+        }
+
+        [[nodiscard]] constexpr index_type required_span_size() const noexcept {
+            auto block_rows = (grid_extents.extent(0) + morton_block_size - 1) / morton_block_size;
+
+            return block_rows * blocks_per_row * morton_block_area;
+        }
+
+        // Partially filled blocks at the right and bottom edges leave gaps, so the mapping isn't exhaustive
+        [[nodiscard]] static constexpr bool is_always_unique() noexcept { return true; }
+        [[nodiscard]] static constexpr bool is_always_exhaustive() noexcept { return false; }
+        [[nodiscard]] static constexpr bool is_always_strided() noexcept { return false; }
+
+        [[nodiscard]] static constexpr bool is_unique() noexcept { return true; }
+        [[nodiscard]] constexpr bool is_exhaustive() const noexcept {
+            return grid_extents.extent(0) % morton_block_size == 0 && grid_extents.extent(1) % morton_block_size == 0;
+        }
+        [[nodiscard]] static constexpr bool is_strided() noexcept { return false; }
+
+        friend constexpr bool operator==(const mapping& lhs, const mapping& rhs) noexcept {
+            return lhs.grid_extents == rhs.grid_extents;
+        }
+    };
+};
+
+} // namespace ant_sim
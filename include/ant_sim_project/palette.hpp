@@ -0,0 +1,36 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tile.hpp"
+#include "types.hpp"
+
+namespace ant_sim {
+
+struct rgb {
+    std::uint8_t r;
+    std::uint8_t g;
+    std::uint8_t b;
+};
+
+// Returns the colour a tile is drawn with, shared by the window and the headless frame exporter
+// Nests are blue, ants are white, food is green, shaded by how full it is, and pheromones are red
+// food_supply is passed separately, as chunked worlds keep food outside of the tiles
+// get_pheromone_strength is only called for tiles that need it, so contents are only loaded then
+template <typename GetPheromoneStrength>
+[[nodiscard]] rgb get_tile_color(const tile& tile, food_supply_t food_supply, food_supply_t max_food_supply,
+                                 GetPheromoneStrength&& get_pheromone_strength) {
+    if(tile.has_nest()) return {0, 0, 255};
+    if(tile.has_ant()) return {255, 255, 255};
+
+    if(food_supply != 0) {
+        return {0, static_cast<std::uint8_t>(255 * food_supply / max_food_supply), 0};
+    }
+
+    auto red = std::clamp(static_cast<float>(get_pheromone_strength()) * 30.0f, 0.0f, 255.0f);
+
+    return {static_cast<std::uint8_t>(red), 0, 0};
+}
+
+} // namespace ant_sim
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ant_sim {
+
+// Stores pheromone strengths and the tick they were last updated at in full precision
+struct exact_pheromone_encoding {
+    using strength_type = pheromone_strength_t;
+    using tick_type = tick_t;
+
+    // Whether stored ticks are relative to an epoch that must be periodically rebased
+    static constexpr bool uses_epoch = false;
+
+    static constexpr strength_type encode_strength(pheromone_strength_t strength) noexcept { return strength; }
+    static constexpr pheromone_strength_t decode_strength(strength_type strength) noexcept { return strength; }
+
+    static constexpr tick_type encode_tick(tick_t tick, tick_t) noexcept { return tick; }
+    static constexpr tick_t decode_tick(tick_type tick, tick_t) noexcept { return tick; }
+};
+
+// Stores pheromone strengths as unsigned 8.8 fixed point numbers, and ticks as 16 bit offsets from an epoch
+// Strengths are rounded to the nearest 1/256, and saturate at 0 and about 256, as they never fade below 0
+// The epoch must be rebased before any stored tick falls more than 65535 ticks behind it
+struct compact_pheromone_encoding {
+    using strength_type = std::uint16_t;
+    using tick_type = std::uint16_t;
+
+    static constexpr bool uses_epoch = true;
+
+    static constexpr pheromone_strength_t scale = 256;
+
+    static constexpr pheromone_strength_t min_strength = 0;
+    static constexpr pheromone_strength_t max_strength = std::numeric_limits<strength_type>::max() / scale;
+
+    static strength_type encode_strength(pheromone_strength_t strength) noexcept {
+        return static_cast<strength_type>(std::lround(std::clamp(strength, min_strength, max_strength) * scale));
+    }
+
+    static constexpr pheromone_strength_t decode_strength(strength_type strength) noexcept {
+        return static_cast<pheromone_strength_t>(strength) / scale;
+    }
+
+    static constexpr tick_type encode_tick(tick_t tick, tick_t epoch) noexcept {
+        return static_cast<tick_type>(tick - epoch);
+    }
+
+    static constexpr tick_t decode_tick(tick_type tick, tick_t epoch) noexcept { return epoch + tick; }
+};
+
+// Building with ANT_SIM_COMPACT_PHEROMONES halves the memory used by pheromones, at the cost of precision
+#ifdef ANT_SIM_COMPACT_PHEROMONES
+using pheromone_encoding = compact_pheromone_encoding;
+#else
+using pheromone_encoding = exact_pheromone_encoding;
+#endif
+
+constexpr std::size_t pheromone_type_count = 2;
+
+// Returns what a pheromone's strength fades to after the given number of ticks
+// Strengths stop fading at 0, so fading over several spans of ticks gives the same result as fading over their total
+[[nodiscard]] inline pheromone_strength_t decay_strength(pheromone_strength_t strength, tick_t ticks_since_last_update,
+                                                         float falloff_rate) noexcept {
+    auto decrease = falloff_rate * static_cast<float>(ticks_since_last_update);
+
+    if(decrease >= strength) return 0;
+
+    return strength - static_cast<pheromone_strength_t>(decrease);
+}
+
+// The pheromones one nest has left on a tile
+// Values are stored using Encoding, and epoch is only used by encodings that store ticks relative to an epoch
+template <typename Encoding>
+struct basic_pheromone_entry {
+    typename Encoding::tick_type last_updated[pheromone_type_count];
+    typename Encoding::strength_type strength[pheromone_type_count];
+    nest_id_t nest_id;
+
+    [[nodiscard]] pheromone_strength_t get_strength(std::size_t type) const noexcept {
+        return Encoding::decode_strength(strength[type]);
+    }
+
+    [[nodiscard]] tick_t get_last_updated(std::size_t type, tick_t epoch) const noexcept {
+        return Encoding::decode_tick(last_updated[type], epoch);
+    }
+
+    // The strength as it has faded by current_tick
+    [[nodiscard]] pheromone_strength_t get_current_strength(std::size_t type, tick_t current_tick, float falloff_rate,
+                                                            tick_t epoch) const noexcept {
+        return decay_strength(get_strength(type), current_tick - get_last_updated(type, epoch), falloff_rate);
+    }
+
+    void set(std::size_t type, pheromone_strength_t new_strength, tick_t tick, tick_t epoch) noexcept {
+        strength[type] = Encoding::encode_strength(new_strength);
+        last_updated[type] = Encoding::encode_tick(tick, epoch);
+    }
+
+    // Checks if every strength has faded to 0 by current_tick
+    [[nodiscard]] bool has_faded(tick_t current_tick, float falloff_rate, tick_t epoch) const noexcept {
+        for(auto i = 0uz; i < pheromone_type_count; i++) {
+            if(get_current_strength(i, current_tick, falloff_rate, epoch) != 0) return false;
+        }
+
+        return true;
+    }
+};
+
+// Holds the entries that don't fit within a tile, in a chain of blocks starting from the tile
+template <typename Encoding>
+struct basic_pheromone_block {
+    static constexpr std::size_t capacity = 6;
+
+    basic_pheromone_entry<Encoding> entries[capacity];
+    std::uint8_t count;
+    basic_pheromone_block* next;
+};
+
+// Owns the overflow blocks of every tile in a world
+// Blocks never move once allocated, and released blocks are reused rather than freed
+template <typename Encoding>
+class basic_pheromone_pool {
+    using block_type = basic_pheromone_block<Encoding>;
+
+    std::deque<block_type> blocks;
+    std::vector<block_type*> free_blocks;
+
+  public:
+    basic_pheromone_pool() = default;
+
+    // Tiles point into the pool, so it can't be copied
+    basic_pheromone_pool(const basic_pheromone_pool&) = delete;
+    basic_pheromone_pool& operator=(const basic_pheromone_pool&) = delete;
+
+    // Returns an empty block
+    [[nodiscard]] block_type* allocate() {
+        if(free_blocks.empty()) return &blocks.emplace_back();
+
+        auto* block = free_blocks.back();
+        free_blocks.pop_back();
+
+        *block = {};
+
+        return block;
+    }
+
+    void release(block_type* block) { free_blocks.push_back(block); }
+
+    [[nodiscard]] std::size_t blocks_in_use() const noexcept { return blocks.size() - free_blocks.size(); }
+
+    [[nodiscard]] std::size_t memory_usage() const noexcept {
+        return blocks.size() * sizeof(block_type) + free_blocks.capacity() * sizeof(block_type*);
+    }
+};
+
+// The pheromones every nest has left on a tile
+// Only nests that have marked the tile have an entry, so the cost of a lookup depends on how many nests marked it,
+// and the size of a tile doesn't depend on how many nests there are
+// The first inline_capacity entries are stored in the tile, and any more in blocks from a basic_pheromone_pool
+//
+// All bytes being zero means no nest has marked the tile
+// Nests without an entry have a strength of 0
+// Stored strengths are only brought up to date when they are written to, and reads work out how far they have faded,
+// so reading never modifies the tile. Entries that have faded away are removed the next time the tile is written to
+// Entries are kept contiguous, so the overflow blocks are only used once the inline entries are full
+template <typename Encoding>
+struct basic_pheromone_trails {
+    using entry_type = basic_pheromone_entry<Encoding>;
+    using block_type = basic_pheromone_block<Encoding>;
+    using pool_type = basic_pheromone_pool<Encoding>;
+
+    // Most tiles are only ever marked by one or two nests
+    static constexpr std::size_t inline_capacity = 2;
+
+    entry_type entries[inline_capacity];
+    std::uint8_t count; // The number of inline entries in use
+    block_type* overflow;
+
+    [[nodiscard]] const entry_type* find(nest_id_t nest_id) const noexcept {
+        for(auto i = 0uz; i < count; i++) {
+            if(entries[i].nest_id == nest_id) return &entries[i];
+        }
+
+        for(const auto* block = overflow; block; block = block->next) {
+            for(auto i = 0uz; i < block->count; i++) {
+                if(block->entries[i].nest_id == nest_id) return &block->entries[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    [[nodiscard]] entry_type* find(nest_id_t nest_id) noexcept {
+        return const_cast<entry_type*>(std::as_const(*this).find(nest_id));
+    }
+
+    // Calls f on every entry, in no particular order
+    void for_each_entry(this auto&& self, auto&& f) {
+        for(auto i = 0uz; i < self.count; i++) {
+            f(self.entries[i]);
+        }
+
+        for(auto* block = self.overflow; block; block = block->next) {
+            for(auto i = 0uz; i < block->count; i++) {
+                f(block->entries[i]);
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t entry_count() const noexcept {
+        auto result = static_cast<std::size_t>(count);
+
+        for(const auto* block = overflow; block; block = block->next) {
+            result += block->count;
+        }
+
+        return result;
+    }
+
+    // Checks if the nest has no pheromones on this tile
+    [[nodiscard]] bool is_untouched(nest_id_t nest_id) const noexcept { return find(nest_id) == nullptr; }
+
+    // The strength as stored, which doesn't account for fading since it was last updated
+    [[nodiscard]] pheromone_strength_t get_strength(nest_id_t nest_id, std::size_t type) const noexcept {
+        const auto* entry = find(nest_id);
+
+        return entry ? entry->get_strength(type) : 0;
+    }
+
+    // The strength as it has faded by current_tick
+    [[nodiscard]] pheromone_strength_t get_current_strength(nest_id_t nest_id, std::size_t type, tick_t current_tick,
+                                                            float falloff_rate, tick_t epoch) const noexcept {
+        const auto* entry = find(nest_id);
+
+        return entry ? entry->get_current_strength(type, current_tick, falloff_rate, epoch) : 0;
+    }
+
+    // Nests without an entry read as last updated at the epoch
+    [[nodiscard]] tick_t get_last_updated(nest_id_t nest_id, std::size_t type, tick_t epoch) const noexcept {
+        const auto* entry = find(nest_id);
+
+        return entry ? entry->get_last_updated(type, epoch) : Encoding::decode_tick(0, epoch);
+    }
+
+    void set(nest_id_t nest_id, std::size_t type, pheromone_strength_t strength, tick_t tick, tick_t epoch,
+             pool_type& pool) {
+        auto* entry = find(nest_id);
+
+        if(!entry) entry = &insert(nest_id, pool);
+
+        entry->set(type, strength, tick, epoch);
+    }
+
+    // Brings the nest's strengths up to date, then adds amount to the strength of the given type
+    // Also removes the entries of any nests whose pheromones have faded away
+    void deposit(nest_id_t nest_id, std::size_t type, pheromone_strength_t amount, tick_t current_tick,
+                 float falloff_rate, tick_t epoch, pool_type& pool) {
+        erase_faded(current_tick, falloff_rate, epoch, pool);
+
+        auto* entry = find(nest_id);
+
+        if(!entry) entry = &insert(nest_id, pool);
+
+        // A new entry's strengths are all 0, so it doesn't matter when they count as last updated
+        for(auto i = 0uz; i < pheromone_type_count; i++) {
+            auto strength = entry->get_current_strength(i, current_tick, falloff_rate, epoch);
+
+            entry->set(i, i == type ? strength + amount : strength, current_tick, epoch);
+        }
+    }
+
+    // Decays every entry to current_tick, and stores their ticks relative to new_epoch instead of epoch
+    // Entries that have faded away are removed
+    void rebase(tick_t current_tick, float falloff_rate, tick_t epoch, tick_t new_epoch, pool_type& pool) {
+        erase_faded(current_tick, falloff_rate, epoch, pool);
+
+        for_each_entry([&](entry_type& entry) {
+            for(auto i = 0uz; i < pheromone_type_count; i++) {
+                entry.set(i, entry.get_current_strength(i, current_tick, falloff_rate, epoch), current_tick, new_epoch);
+            }
+        });
+    }
+
+  private:
+    // Removes every entry whose strengths have all faded to 0 by current_tick
+    void erase_faded(tick_t current_tick, float falloff_rate, tick_t epoch, pool_type& pool) {
+        if(count == 0) return;
+
+        auto find_faded = [&]() -> entry_type* {
+            entry_type* faded = nullptr;
+
+            for_each_entry([&](entry_type& entry) {
+                if(!faded && entry.has_faded(current_tick, falloff_rate, epoch)) faded = &entry;
+            });
+
+            return faded;
+        };
+
+        // Erasing moves the last entry into the erased entry's place, so search again after each one
+        while(auto* faded = find_faded()) erase(*faded, pool);
+    }
+
+    entry_type& insert(nest_id_t nest_id, pool_type& pool) {
+        entry_type* entry = nullptr;
+
+        if(count < inline_capacity) {
+            entry = &entries[count++];
+        } else {
+            // Entries are contiguous, so only the last block in the chain can have room
+            auto* last = overflow;
+
+            while(last && last->next) last = last->next;
+
+            if(!last || last->count == block_type::capacity) {
+                auto* block = pool.allocate();
+
+                (last ? last->next : overflow) = block;
+                last = block;
+            }
+
+            entry = &last->entries[last->count++];
+        }
+
+        *entry = {};
+        entry->nest_id = nest_id;
+
+        return *entry;
+    }
+
+    // Moves the last entry into the removed entry's place, to keep the entries contiguous
+    void erase(entry_type& entry, pool_type& pool) {
+        if(!overflow) {
+            entry = entries[--count];
+            return;
+        }
+
+        block_type* previous = nullptr;
+        auto* last = overflow;
+
+        while(last->next) {
+            previous = last;
+            last = last->next;
+        }
+
+        entry = last->entries[--last->count];
+
+        if(last->count == 0) {
+            (previous ? previous->next : overflow) = nullptr;
+            pool.release(last);
+        }
+    }
+};
+
+} // namespace ant_sim
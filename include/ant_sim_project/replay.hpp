@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// A simulation parameter that can be changed while the simulation is running
+struct tunable_parameter {
+    const char* name;
+    float simulation::* member;
+};
+
+// Every parameter that affects how the simulation plays out, and that can be changed while it runs
+// clang-format off
+inline constexpr tunable_parameter tunable_parameters[] = {
+    {"hunger_increase_per_tick", &simulation::hunger_increase_per_tick},
+    {"hunger_to_die", &simulation::hunger_to_die},
+    {"food_taken", &simulation::food_taken},
+    {"food_resupply_rate", &simulation::food_resupply_rate},
+    {"max_food_supply", &simulation::max_food_supply},
+    {"food_per_new_ant", &simulation::food_per_new_ant},
+    {"food_hunger_ratio", &simulation::food_hunger_ratio},
+    {"falloff_rate", &simulation::falloff_rate},
+    {"increase_rate", &simulation::increase_rate},
+    {"type1_avoidance", &simulation::type1_avoidance},
+    {"type2_avoidance", &simulation::type2_avoidance}
+};
+// clang-format on
+
+// Replay journals are text files with one record per line, in the same style as the simulation's log
+//   Journal,<version>
+//   Seed,<seed>
+//   Args,<rows>,<columns>,... in the same order as the command line arguments, without the seed
+//   Map,<checksum>,<path>        Only for runs started from a world map, whose path is the rest of the line
+//   Sort,<interval>              Only for runs that sort their ants at a different interval than the default
+//   Param,<tick>,<name>,<value>  The parameter was changed before the given tick ran
+//   State,<tick>,<state>         The simulation was paused, resumed or stepped before the given tick ran
+//   End,<tick>                   The run stopped once the tick count reached the given tick
+// Floats are written with enough digits to be read back exactly
+// Pausing and stepping don't change how the simulation plays out, so State records are only informational
+
+// Writes a replay journal while the simulation runs
+// Parameters are compared with their last recorded values, so changes are caught no matter where they came from
+class replay_recorder {
+    std::ofstream file;
+
+    float recorded_parameters[std::size(tunable_parameters)];
+    simulation::simulation_state recorded_state;
+
+  public:
+    // Throws std::runtime_error if the file can't be opened
+    replay_recorder(const std::filesystem::path& path, const simulation& sim, const simulation_args_t& args);
+
+    // Records any parameters or state that changed since the last call
+    // Must be called before every tick that follows a change, while the simulation is locked
+    void record_changes(const simulation& sim);
+
+    void record_end(const simulation& sim);
+};
+
+struct parameter_change {
+    tick_t tick;
+    std::size_t parameter; // An index into tunable_parameters
+    float value;
+};
+
+struct replay_journal {
+    simulation_args_t args;                // Including the seed
+    std::vector<parameter_change> changes; // In the order they were made
+    std::optional<tick_t> end_tick;        // Missing if the recording run didn't exit cleanly
+};
+
+// Throws std::runtime_error if the journal can't be read
+[[nodiscard]] replay_journal read_journal(const std::filesystem::path& path);
+
+// Runs sim until its tick count reaches end_tick or it stops
+// The journal's parameter changes are applied at the ticks they were recorded at
+// sim must have been created from journal.args
+void replay(simulation& sim, const replay_journal& journal, tick_t end_tick);
+
+} // namespace ant_sim
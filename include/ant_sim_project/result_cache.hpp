@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "simulation.hpp"
+#include "termination.hpp"
+#include "tick_counters.hpp"
+
+namespace ant_sim {
+
+// The metrics kept for a finished run
+struct run_summary {
+    tick_t ticks = 0;
+    termination_reason termination = termination_reason::none;
+    std::size_t ant_count = 0;
+    double food_count = 0;
+    std::size_t births = 0;
+    std::size_t deaths = 0;
+    std::uint64_t state_hash = 0;
+    std::vector<nest_stats> nests;
+};
+
+[[nodiscard]] run_summary summarise(const simulation& sim);
+
+// Returns everything that determines how a run plays out, as semicolon separated text
+// This is the arguments including the seed, the tick limit, the food chance and SIMULATION_VERSION from version.hpp
+// Runs from a world map also include its checksum
+// The memory options are left out, as they don't change the results
+// Throws std::runtime_error if args has no seed, as the results of a random seed can't be reused
+[[nodiscard]] std::string describe_run(const simulation_args_t& args, tick_t max_ticks);
+
+// The key a run's results are stored under, which is a 64 bit FNV-1a hash of describe_run
+[[nodiscard]] std::uint64_t make_run_key(const simulation_args_t& args, tick_t max_ticks);
+
+// Stores the summaries of finished runs in a file, so that they are never computed twice
+// The file is a text file with one record per line, in the same style as the simulation's log
+//   Result,<key>,<description>,<ticks>,<termination>,<ants>,<food>,<births>,<deaths>,<hash>,<nests>,...
+// followed by the population, births, deaths and food gathered of each nest
+// The description is checked when looking a run up, so a hash collision can't return another run's results
+//
+// Records are only ever appended and flushed one at a time, so a crash loses at most the run being recorded
+// Lines that can't be read, such as one cut off by a crash, are skipped
+class result_cache {
+    std::ofstream file;
+
+    struct entry {
+        std::string description;
+        run_summary summary;
+    };
+
+    std::unordered_map<std::uint64_t, entry> results;
+
+    std::size_t skipped_lines = 0;
+
+  public:
+    // Loads every result already in the file, creating it if it doesn't exist
+    // Throws std::runtime_error if the file can't be opened
+    explicit result_cache(const std::filesystem::path& path);
+
+    // Returns the stored summary of the run, or nullptr if it hasn't been run
+    [[nodiscard]] const run_summary* find(const simulation_args_t& args, tick_t max_ticks) const;
+
+    // Stores the summary of a finished run, replacing any stored before
+    void store(const simulation_args_t& args, tick_t max_ticks, const run_summary& summary);
+
+    [[nodiscard]] std::size_t size() const noexcept { return results.size(); }
+
+    // The number of lines that couldn't be read when loading the file
+    [[nodiscard]] std::size_t get_skipped_lines() const noexcept { return skipped_lines; }
+};
+
+} // namespace ant_sim
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stop_token>
+
+#include "simulation.hpp"
+#include "replay.hpp"
+#include "frame_exporter.hpp"
+#include "delta_stream.hpp"
+#include "shared_snapshot.hpp"
+
+namespace ant_sim {
+
+// Runs the simulation on the calling thread until it is stopped, stop_token is triggered, or max_ticks have passed
+// Ticks are scheduled against absolute deadlines, so the time spent ticking doesn't lower the tick rate
+// Up to simulation::ticks_per_step ticks are run each time the lock is acquired
+// If recorder isn't null, parameter and state changes are recorded to it before each batch of ticks
+// If exporter isn't null, it's given the chance to export a frame after every tick
+// If deltas isn't null, the tiles changed by every tick are written to it
+// If snapshots isn't null, it's given the chance to publish a snapshot after every tick
+void run_simulation(const std::stop_token& stop_token, simulation_mutex& sim, tick_t max_ticks,
+                    replay_recorder* recorder, frame_exporter* exporter, delta_writer* deltas,
+                    snapshot_publisher* snapshots);
+
+} // namespace ant_sim
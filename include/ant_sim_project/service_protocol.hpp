@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// The protocol spoken by ant_sim_service over its Unix domain socket
+// A client may send any number of requests on one connection, and may send more before earlier ones are answered
+// Responses are sent as runs finish, so they can arrive in a different order than their requests
+//
+// Requests are text lines, in the same style as the simulation's log:
+//   Run,<id>,<seed>,<max ticks>,<metrics>,<map>,<rows>,<columns>,<nests>,<ants per nest>,...
+// The fields after the map are the same as the command line arguments after the seed, and any left out keep
+// their default values. The map is the path of a world map to start from, or - to generate the world
+// The metrics are any of summary, nests and hash, joined with +
+//
+// Responses are binary, and every value is little endian
+//   u32 length of the rest of the response, u32 request id, u8 status
+//   Status 0, the run finished: u8 metrics as a bit set of run_metric, then each requested metric in this order
+//     summary: u32 ticks, u8 termination reason, u64 ants, f64 food, u64 births, u64 deaths
+//     nests:   u8 nest count, then for each nest u64 population, u64 births, u64 deaths, f64 food gathered
+//     hash:    u64 state hash, as printed by --hash-every
+//   Status 1, the request failed: the error message fills the rest of the response
+enum run_metric : std::uint8_t {
+    metric_summary = 1 << 0,
+    metric_nests = 1 << 1,
+    metric_hash = 1 << 2
+};
+
+struct run_request {
+    std::uint32_t id = 0;
+    tick_t max_ticks = 0;
+    std::uint8_t metrics = 0;
+
+    // args.map is left for the service to fill in, so that it can share maps between requests
+    std::optional<std::filesystem::path> map_path;
+
+    simulation_args_t args = {};
+};
+
+// Parses a Run line into request
+// request.id is read before anything else is checked, so that errors can be reported against it
+// Throws std::runtime_error if the line isn't a valid request
+void parse_run_request(std::string_view line, run_request& request);
+
+// Encodes the requested metrics of a finished run
+[[nodiscard]] std::vector<std::uint8_t> encode_run_response(std::uint32_t id, std::uint8_t metrics,
+                                                            const simulation& sim);
+
+[[nodiscard]] std::vector<std::uint8_t> encode_error_response(std::uint32_t id, std::string_view message);
+
+} // namespace ant_sim
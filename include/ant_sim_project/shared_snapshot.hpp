@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dirty_tiles.hpp"
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// Shared snapshots publish the world into a POSIX shared memory object, so that other processes can watch a run
+// by mapping it read-only, at their own rate and without parsing the log
+//
+// The object starts with a snapshot_header, followed by plane_count snapshot_plane, and then two buffers
+// The buffers are written alternately, and latest_buffer holds the index of the last one that was completed
+// Every value is in the machine's native byte order, and everything is aligned to its type
+//
+// Each buffer is guarded by a seqlock: its sequence is odd while it is being written, and goes up by 2 each time
+// To read a buffer, load its sequence with acquire ordering and retry if it is odd, read what is needed,
+// then load the sequence again after an acquire fence. The read is only valid if the sequence hasn't changed
+// A buffer is only rewritten two snapshots after it was completed, so readers rarely have to retry
+struct snapshot_header {
+    char magic[8]; // "ANTSNAP" followed by a zero byte
+    std::uint32_t version;
+    std::uint32_t plane_count;
+
+    std::uint64_t rows;
+    std::uint64_t columns;
+    std::uint64_t nest_count;
+    std::uint64_t ant_capacity; // The most ants a buffer can hold
+
+    std::uint64_t buffer_offsets[2]; // From the start of the object
+    std::uint64_t buffer_size;
+
+    // The offsets of each part of a buffer, from the start of the buffer
+    std::uint64_t tiles_offset;  // rows x columns u8 tile flags, as in tile.hpp
+    std::uint64_t food_offset;   // rows x columns f32 food supplies
+    std::uint64_t planes_offset; // plane_count planes of rows x columns f32 pheromone strengths
+    std::uint64_t ants_offset;   // ant_capacity snapshot_ant
+    std::uint64_t nests_offset;  // nest_count snapshot_nest
+
+    // Accessed atomically, and ~0 until the first snapshot is published
+    std::uint64_t latest_buffer;
+};
+
+// A pheromone trail copied into each snapshot
+struct snapshot_plane {
+    std::uint32_t nest_id;
+    std::uint32_t type;
+};
+
+// The start of each buffer
+struct snapshot_buffer_header {
+    std::uint64_t sequence; // Accessed atomically
+    std::uint64_t tick;
+    std::uint64_t ant_count;   // Every living ant
+    std::uint64_t ants_stored; // The ants in the buffer, which is fewer than ant_count if there wasn't room
+    double food_count;
+    std::uint64_t births;
+    std::uint64_t deaths;
+};
+
+struct snapshot_ant {
+    std::uint32_t x;
+    std::uint32_t y;
+    std::uint32_t ant_id;
+    std::uint8_t nest_id;
+    std::uint8_t caste; // 0 for queens, 1 for workers
+    std::uint8_t state; // 0 while searching, 1 while returning with food
+    std::uint8_t padding;
+};
+
+struct snapshot_nest {
+    std::uint32_t x;
+    std::uint32_t y;
+    float food_supply;
+    std::uint32_t padding;
+    std::uint64_t population;
+    std::uint64_t births;
+    std::uint64_t deaths;
+    double food_gathered;
+};
+
+struct snapshot_options {
+    std::string name; // The shared memory object's name, which starts with a /
+    tick_t interval = 10; // A snapshot is published every this many ticks
+
+    // The pheromone trails copied into each snapshot, as strengths that have faded up to the snapshot's tick
+    std::vector<snapshot_plane> pheromone_planes;
+
+    // The most ants a snapshot can hold, or 0 for 4 times the starting population, but at least 1024
+    std::size_t ant_capacity = 0;
+};
+
+// Publishes snapshots of the simulation into a shared memory object while it runs
+// Publishing happens on the tick thread, but only copies the tiles that changed since the buffer was last written,
+// along with the pheromone planes of the tiles that have had a trail
+// The object is removed once the publisher is destroyed, but readers that have already mapped it can keep reading
+class snapshot_publisher {
+    snapshot_options options;
+
+    std::byte* region = nullptr;
+    std::size_t region_size = 0;
+
+    std::size_t snapshots_published = 0;
+
+    // The tiles changed since each buffer was last written
+    dirty_tiles stale_tiles[2];
+
+    // Every tile that has had a pheromone left on it, which may still be fading
+    dirty_tiles trail_tiles;
+
+    [[nodiscard]] snapshot_header& get_header() noexcept { return *reinterpret_cast<snapshot_header*>(region); }
+
+    // Copies the simulation into the buffer readers aren't using, then makes it the latest
+    // Only the stale tiles are copied, unless whole_world is set
+    void publish(const simulation& sim, bool whole_world);
+
+  public:
+    // The size of the shared memory object a publisher with these options would create for a simulation with args
+    [[nodiscard]] static std::size_t bytes_required(snapshot_options options, const simulation_args_t& args);
+
+    // Creates the shared memory object, replacing any left behind with the same name, and publishes the first snapshot
+    // Throws std::runtime_error if it can't be created, or a pheromone plane names a nest or type that doesn't exist
+    snapshot_publisher(snapshot_options snapshot_options, const simulation& sim);
+
+    snapshot_publisher(const snapshot_publisher&) = delete;
+    snapshot_publisher& operator=(const snapshot_publisher&) = delete;
+
+    ~snapshot_publisher();
+
+    // Notes the tiles the tick changed, and publishes a snapshot if one is due at the simulation's current tick
+    // Must be called after every tick, while the simulation is locked
+    void after_tick(const simulation& sim);
+
+    [[nodiscard]] std::size_t get_snapshots_published() const noexcept { return snapshots_published; }
+};
+
+} // namespace ant_sim
@@ -1,16 +1,28 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <atomic>
 #include <random>
-#include <unordered_map>
+#include <type_traits>
+#include <vector>
 
 #include "tile.hpp"
 #include "ant.hpp"
 #include "nest.hpp"
 #include "types.hpp"
 #include "mutex_guard.hpp"
+#include "arena.hpp"
+#include "grid.hpp"
+#include "termination.hpp"
+#include "stats_history.hpp"
+#include "memory_usage.hpp"
+#include "tick_counters.hpp"
+#include "dirty_tiles.hpp"
+#include "food_map.hpp"
+#include "world_map.hpp"
 
 #include <experimental/mdspan>
 
@@ -18,9 +30,39 @@ namespace ant_sim {
 
 namespace stdex = std::experimental;
 
+// Measures how far the compact pheromone encoding drifts from full precision
+// Only filled in when built with ANT_SIM_VALIDATE_PHEROMONES
+struct pheromone_validation_t {
+    std::size_t decisions = 0;           // The number of movement decisions made
+    std::size_t divergent_decisions = 0; // Decisions that full precision pheromones would have made differently
+
+    std::size_t strength_samples = 0;
+    double total_strength_error = 0;
+    pheromone_strength_t max_strength_error = 0;
+
+    void record_decision(bool diverged) noexcept {
+        decisions++;
+        divergent_decisions += diverged;
+    }
+
+    void record_strength_error(pheromone_strength_t error) noexcept {
+        strength_samples++;
+        total_strength_error += error;
+        max_strength_error = std::max(max_strength_error, error);
+    }
+
+    [[nodiscard]] double mean_strength_error() const noexcept {
+        return strength_samples == 0 ? 0 : total_strength_error / static_cast<double>(strength_samples);
+    }
+};
+
 struct simulation_args_t {
     std::optional<std::uint64_t> seed;
 
+    // Starts from the nests and food of a world map instead of generating them
+    // The map's size and nest count replace rows, columns and nest_count
+    std::shared_ptr<const world_map> map;
+
     std::size_t rows = 100;
     std::size_t columns = 100;
     nest_id_t nest_count = 2;
@@ -37,6 +79,19 @@ struct simulation_args_t {
     pheromone_strength_t increase_rate = 6;
     float type1_avoidance = 1.0f;
     float type2_avoidance = 1.0f;
+
+    // Ants are sorted by their location every this many ticks, or never if 0
+    // Ticking them in that order walks the world roughly in order, instead of jumping around it for every ant
+    tick_t ant_sort_interval = 32;
+
+    // Whether the seed, nests, ticks, births and deaths are logged, which set_log_events can change later
+    bool log_events = true;
+
+    // Controls the pages used for the tile grid
+    arena_options tile_memory = {};
+
+    // Controls whether the simulation stops early
+    termination_policy termination = {};
 };
 
 class simulation {
@@ -48,7 +103,9 @@ class simulation {
         paused       // The simulation is paused
     };
 
-    float food_chance = 0.01f; // Chance that any given tile has food
+    static constexpr float default_food_chance = 0.01f;
+
+    float food_chance = default_food_chance; // Chance that any given tile has food
 
     float hunger_increase_per_tick;
     float hunger_to_die;
@@ -75,19 +132,72 @@ class simulation {
 
     std::minstd_rand rng;
 
-    std::chrono::duration<float, std::milli> sleep_time{100};
+    pheromone_validation_t pheromone_validation;
+
+    // The number of ticks to run per second, ignored if run_unlimited is true
+    float target_tick_rate = 10;
+    // Run ticks back to back instead of waiting for the next deadline
+    bool run_unlimited = false;
+    // The number of ticks to run each time the simulation thread acquires the lock
+    // The renderer only sees the state after each batch, so larger values fast-forward with less locking overhead
+    tick_t ticks_per_step = 1;
+
+    // Print a hash of the simulation's state every this many ticks, or never if 0
+    // Comparing the hashes of two runs finds the first tick where they diverged
+    tick_t hash_interval = 0;
 
   private:
-    std::size_t rows;
-    std::size_t columns;
+    // Tiles are split in two, so that checking whether a tile can be moved to doesn't load its pheromones
+    // Only the tiles have a border, as the contents of full tiles are never read
+    bordered_world_grid<tile> tiles;
+    world_grid<tile_contents> contents;
+
+    // Holds the pheromone entries that don't fit within their tile
+    tile::pheromone_pool pheromone_pool;
 
-    std::vector<tile> tiles;
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    tile::basic_pheromone_pool<exact_pheromone_encoding> exact_pheromone_pool;
+#endif
 
-    std::unordered_map<ant_id_t, ant> ants;
+    // The seed rng was created from, which was chosen randomly if none was given
+    std::uint64_t seed;
+
+    stats_history history;
+
+    // The values recorded to history for the current tick, kept to avoid allocating every tick
+    std::vector<float> history_values;
+
+    // The changes made during the current tick, published once it has finished
+    tick_counters counters;
+
+    // The tiles changed during the current tick, or the last one once it has finished
+    dirty_tiles dirty;
+
+    // Indexed by nest id
+    std::vector<nest_stats> nest_statistics;
+
+    // Adds the current tick's counters to the totals
+    void publish_counters();
+
+    void record_history(std::chrono::steady_clock::time_point tick_start);
+
+    // Sorted by location every ant_sort_interval ticks, with ants born since then at the end
+    std::vector<ant> ants;
     std::vector<nest> nests;
 
+    tick_t ant_sort_interval = 0;
+
+    // Sorts ants along a Z-order curve through their locations
+    // Ties are broken by id, so the order only depends on the seed
+    void sort_ants();
+
     std::vector<point<>> food_sources;
 
+#ifdef ANT_SIM_CHUNKED_WORLD
+    // Chunked worlds keep their food out of the grids, so placing it doesn't allocate every chunk
+    food_map food_supplies;
+#endif
+
     // All members of this struct must always be accessed via std::atomic_ref, as multiple threads may access them.
     // Each member is independent of the others.  There is no need to pass the entire struct to std::atomic_ref.
     struct {
@@ -98,13 +208,18 @@ class simulation {
         // Ensure mouse_location is sufficiently aligned to use with std::atomic_ref
         alignas(std::atomic_ref<point_t>::required_alignment) point_t mouse_location = {0, 0};
 
-        float food_count = 0;
+        // Kept in double precision, so that adding small changes to a large total doesn't lose them
+        double food_count = 0;
 
         bool log_ant_movements = false;
         bool log_ant_state_changes = true;
+        bool log_events = true; // Seed, nests, ticks, births and deaths
 
         std::size_t births = 0;
         std::size_t deaths = 0;
+
+        // The tick rate measured by the simulation thread
+        float achieved_tick_rate = 0;
     } atomically_accessed;
 
     // Holds new ants that have not yet been added to the simulation
@@ -113,8 +228,32 @@ class simulation {
     // The lowest unused id
     ant_id_t next_id = 0;
 
-    simulation(std::size_t rows, std::size_t columns, nest_id_t nest_count, ant_id_t ant_count_per_nest,
-               std::optional<std::uint64_t> seed = {});
+    // Compact pheromones store their ticks relative to this
+    tick_t pheromone_epoch = 0;
+
+    termination_monitor termination;
+
+    // Why the simulation stopped early, and the tick count when it did
+    termination_reason terminated_by = termination_reason::none;
+    tick_t termination_tick = 0;
+
+    // The estimate made from the arguments the simulation was created from
+    memory_usage estimated_memory;
+
+    // Moves pheromone_epoch up to the current tick, re-encoding every stored tick relative to it
+    void rebase_pheromones();
+
+    // Creates the world, with args already resolved against its world map
+    simulation(const simulation_args_t& args, std::uint64_t seed);
+
+    // Places a nest with the next nest id at location
+    void add_nest(point<> location);
+
+    // Gives each nest ant_count_per_nest ants, the first of which is its queen
+    void populate_nests(ant_id_t ant_count_per_nest);
+
+    // Places a food source at location, without adding its supply to the food count
+    void add_food_source(point<> location, food_supply_t supply);
 
   public:
     simulation(simulation_args_t args);
@@ -141,35 +280,160 @@ class simulation {
     bool get_log_ant_state_changes() const noexcept;
     void set_log_ant_state_changes(bool log_ant_state_changes) noexcept;
 
+    bool get_log_events() const noexcept;
+    void set_log_events(bool log_events) noexcept;
+
     [[nodiscard]] tick_t get_tick_count() const noexcept;
 
-    [[nodiscard]] float get_food_count() const noexcept;
-    void set_food_count(float food_count) noexcept;
+    [[nodiscard]] float get_achieved_tick_rate() const noexcept;
+    void set_achieved_tick_rate(float achieved_tick_rate) noexcept;
+
+    // The food on the map, births and deaths are only updated once each tick has finished
+    [[nodiscard]] double get_food_count() const noexcept;
+    void set_food_count(double food_count) noexcept;
 
     [[nodiscard]] std::size_t get_births() const noexcept;
     [[nodiscard]] std::size_t get_deaths() const noexcept;
 
-    void increment_births() noexcept;
-    void increment_deaths() noexcept;
+    // Returns a std::span referring to the statistics of each nest, indexed by nest id
+    [[nodiscard]] std::span<const nest_stats> get_nest_stats() const noexcept { return nest_statistics; }
 
     // Returns a rows x columns std::mdspan referring to tiles
-    [[nodiscard]] auto get_tiles(this auto&& self) noexcept {
-        return stdex::mdspan{self.tiles.data(), self.rows, self.columns};
+    // With a chunked world, writing through the returned span allocates chunks, so read through a const simulation
+    [[nodiscard]] auto get_tiles(this auto&& self) noexcept { return self.tiles.span(); }
+
+    // Returns a rows x columns std::mdspan referring to the contents of each tile, with the same indices as get_tiles
+    [[nodiscard]] auto get_tile_contents(this auto&& self) noexcept { return self.contents.span(); }
+
+    // Food is kept in the tiles, except in chunked worlds, so these must be used rather than reading the tiles' food
+    [[nodiscard]] bool has_food(point<> location) const noexcept {
+#ifdef ANT_SIM_CHUNKED_WORLD
+        return food_supplies.get(location) != 0;
+#else
+        return get_tiles()[location.y, location.x].has_food();
+#endif
+    }
+
+    // Returns the food on the tile at location, which is 0 if it has none
+    [[nodiscard]] food_supply_t get_food_supply(point<> location) const noexcept {
+#ifdef ANT_SIM_CHUNKED_WORLD
+        return food_supplies.get(location);
+#else
+        return has_food(location) ? get_tile_contents()[location.y, location.x].food_supply : 0;
+#endif
+    }
+
+    void set_food_supply(point<> location, food_supply_t supply) {
+#ifdef ANT_SIM_CHUNKED_WORLD
+        food_supplies.set(location, supply);
+#else
+        get_tile_contents()[location.y, location.x].food_supply = supply;
+        get_tiles()[location.y, location.x].set_has_food(supply != 0);
+#endif
+    }
+
+    // Returns the flags of the tile at location, with tile::has_food_flag set if it has food wherever that is kept
+    [[nodiscard]] std::uint8_t get_tile_flags(point<> location) const noexcept {
+        auto flags = get_tiles()[location.y, location.x].flags;
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+        if(food_supplies.get(location) != 0) flags = static_cast<std::uint8_t>(flags | tile::has_food_flag);
+#endif
+
+        return flags;
     }
 
-    // Returns a reference to ants
+#ifdef ANT_SIM_TILE_BORDER
+    // The offsets from a tile to each of its neighbours, in the order of neighbor_directions
+    // Tiles past the edges of the world are full, so every neighbour of a tile in the world can be read
+    [[nodiscard]] const auto& get_tile_neighbor_offsets() const noexcept { return tiles.get_neighbor_offsets(); }
+#endif
+
+    // Reads how much of the tile grids are resident, and how much of them are backed by huge pages
+    [[nodiscard]] arena_stats get_tile_memory_stats() const;
+
+    // Measures the memory currently used by each part of the simulation
+    // Tiles count the pages of the grids that are resident, which reads from the OS, so avoid calling this every tick
+    [[nodiscard]] memory_usage get_memory_usage() const;
+
+    // Predicts the peak memory of a simulation created from args, without creating it
+    // Tiles are counted as if every page of the grids has been written to
+    // Ants are counted at their starting population, as how far colonies grow depends on how the run plays out
+    // A world map's pages are left out, as they belong to the page cache and are shared between processes
+    [[nodiscard]] static memory_usage estimate_memory_usage(const simulation_args_t& unresolved_args);
+
+    [[nodiscard]] const memory_usage& get_estimated_memory_usage() const noexcept { return estimated_memory; }
+
+    // Returns a reference to ants, which are in the order they are ticked in
     [[nodiscard]] auto& get_ants(this auto&& self) noexcept { return self.ants; }
 
+    // Returns the living ant with id ant_id, or nullptr if there isn't one
+    // Searches every ant, so it is only meant for looking up the odd ant, such as the one under the mouse
+    [[nodiscard]] const ant* find_ant(ant_id_t ant_id) const noexcept;
+
     // Returns a std::span referring to nests
     [[nodiscard]] auto get_nests(this auto&& self) noexcept { return std::span{self.nests}; }
 
-    // Updates the strength of the pheromone trails to account for fading over time
-    void update_pheromones(tile::pheromone_trails& pheromone_trails, tick_t current_tick, nest_id_t nest_id);
+    // The tiles that food is placed on and resupplied to
+    [[nodiscard]] std::span<const point<>> get_food_sources() const noexcept { return food_sources; }
+
+    [[nodiscard]] tick_t get_pheromone_epoch() const noexcept { return pheromone_epoch; }
+
+    // Records that the tile at location changed during the current tick
+    // Pheromones fading isn't a change, as their current strength can be worked out from what is stored
+    void mark_dirty(point<> location) { dirty.mark(location); }
+
+    // The tiles whose contents changed during the last tick
+    [[nodiscard]] const dirty_tiles& get_dirty_tiles() const noexcept { return dirty; }
+
+    [[nodiscard]] std::uint64_t get_seed() const noexcept { return seed; }
+
+    // The history of the simulation's statistics, which can be read from any thread without locking
+    [[nodiscard]] const stats_history& get_stats_history() const noexcept { return history; }
+
+    // Returns termination_reason::none unless the termination policy stopped the simulation
+    [[nodiscard]] termination_reason get_termination_reason() const noexcept { return terminated_by; }
+    [[nodiscard]] tick_t get_termination_tick() const noexcept { return termination_tick; }
+
+    // Returns the pool that holds the overflowing entries of trails stored with Encoding
+    template <typename Encoding>
+    [[nodiscard]] tile::basic_pheromone_pool<Encoding>& get_pheromone_pool() noexcept {
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+        if constexpr(std::is_same_v<Encoding, exact_pheromone_encoding> &&
+                     !std::is_same_v<pheromone_encoding, exact_pheromone_encoding>) {
+            return exact_pheromone_pool;
+        } else {
+            return pheromone_pool;
+        }
+#else
+        return pheromone_pool;
+#endif
+    }
+
+    // Reads the strength of a pheromone as it has faded by the current tick, without modifying the trails
+    template <typename Encoding>
+    [[nodiscard]] pheromone_strength_t get_pheromone_strength(const tile::basic_pheromone_trails<Encoding>& trails,
+                                                              nest_id_t nest_id, std::size_t type) const noexcept {
+        return trails.get_current_strength(nest_id, type, get_tick_count(), falloff_rate, pheromone_epoch);
+    }
+
+    // Strengthens the pheromone of the given type left by the nest
+    // This is the only place pheromones are written to while the simulation runs
+    template <typename Encoding>
+    void deposit_pheromone(tile::basic_pheromone_trails<Encoding>& pheromone_trails, nest_id_t nest_id,
+                           std::size_t type) {
+        pheromone_trails.deposit(nest_id, type, increase_rate, get_tick_count(), falloff_rate, pheromone_epoch,
+                                 get_pheromone_pool<Encoding>());
+    }
 
     void generate(nest_id_t nest_count, ant_id_t ant_count);
 
+    // Places the nests and food of a world map, which doesn't use rng
+    // Throws std::runtime_error if any of them are outside of the world, or a food source has no food
+    void load(const world_map& map, ant_id_t ant_count_per_nest);
+
     // Queues the addition of a new worker ant to the nest with id nest_id
-    // This is done because inserting into a std::unordered_map while iterating is difficult
+    // This is done because adding ants while they are being ticked would invalidate the iteration
     void queue_ant(nest_id_t nest_id);
 
     // Adds a new worker ant to the nest with id new_ant.nest_id
@@ -218,7 +482,20 @@ class simulation_mutex {
         sim.get_unsafe().set_log_ant_state_changes(log_ant_state_changes);
     }
 
+    bool get_log_events() const noexcept { return sim.get_unsafe().get_log_events(); }
+    void set_log_events(bool log_events) noexcept { sim.get_unsafe().set_log_events(log_events); }
+
     [[nodiscard]] tick_t get_tick_count() const noexcept { return sim.get_unsafe().get_tick_count(); }
+
+    [[nodiscard]] float get_achieved_tick_rate() const noexcept { return sim.get_unsafe().get_achieved_tick_rate(); }
+
+    // stats_history synchronizes its own readers and writer, so it doesn't need the lock either
+    [[nodiscard]] const stats_history& get_stats_history() const noexcept {
+        return sim.get_unsafe().get_stats_history();
+    }
+    void set_achieved_tick_rate(float achieved_tick_rate) noexcept {
+        sim.get_unsafe().set_achieved_tick_rate(achieved_tick_rate);
+    }
 };
 
 } // namespace ant_sim
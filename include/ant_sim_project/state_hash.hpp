@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+#include "simulation.hpp"
+
+namespace ant_sim {
+
+// Hashes everything that determines how the simulation will continue: the tiles, ants, nests, food and rng
+// The result doesn't depend on the memory layout of the world
+// It does depend on the order of the ants, as ants are ticked in that order
+// Tiles are visited one by one, so this takes time proportional to the size of the world
+[[nodiscard]] std::uint64_t hash_state(const simulation& sim);
+
+} // namespace ant_sim
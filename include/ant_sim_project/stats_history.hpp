@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ant_sim {
+
+// The history of the simulation's statistics over the whole run, in a fixed amount of memory
+// Each series holds up to capacity samples, and each sample is the mean of stride consecutive ticks
+// Once the series are full, neighbouring samples are merged in pairs and the stride doubles
+// so older history is kept at an ever coarser resolution instead of being dropped
+//
+// Only the tick thread may record samples
+// Any thread may read a snapshot at any time, without locking, through a sequence lock
+class stats_history {
+  public:
+    // The series recorded for the whole simulation
+    // These are followed by the series for each nest, see nest_population and nest_food
+    enum series : std::size_t {
+        ant_count,
+        food_count,
+        births,       // Births per tick
+        deaths,       // Deaths per tick
+        tick_time_ms, // Milliseconds taken per tick
+        fixed_series_count
+    };
+
+    static constexpr std::size_t capacity = 512;
+
+    // A consistent copy of every series
+    struct snapshot {
+        std::size_t count = 0; // The number of samples in each series
+        tick_t stride = 1;     // The number of ticks each sample covers
+        std::vector<float> samples;
+
+        // Returns a pointer to the count samples of the given series
+        [[nodiscard]] const float* get_series(std::size_t series) const noexcept {
+            return samples.data() + series * capacity;
+        }
+    };
+
+  private:
+    std::size_t series_count = fixed_series_count;
+
+    // series_count * capacity samples, one series after another
+    // Accessed through std::atomic_ref, as readers copy them while the tick thread may be writing
+    std::vector<float> samples;
+
+    // Odd while the tick thread is writing
+    std::atomic<std::uint64_t> sequence = 0;
+
+    std::atomic<std::size_t> count = 0;
+    std::atomic<tick_t> stride = 1;
+
+    // Only accessed by the tick thread
+    std::vector<double> pending_sums;
+    tick_t pending_ticks = 0;
+
+    [[nodiscard]] float load(std::size_t index) const noexcept;
+    void store(std::size_t index, float value) noexcept;
+
+    void append() noexcept;
+    void merge_pairs() noexcept;
+
+  public:
+    explicit stats_history(std::size_t nest_count = 0);
+
+    stats_history(const stats_history&) = delete;
+    stats_history& operator=(const stats_history&) = delete;
+
+    [[nodiscard]] static constexpr std::size_t nest_population(std::size_t nest_id) noexcept {
+        return fixed_series_count + nest_id * 2;
+    }
+    [[nodiscard]] static constexpr std::size_t nest_food(std::size_t nest_id) noexcept {
+        return fixed_series_count + nest_id * 2 + 1;
+    }
+
+    [[nodiscard]] std::size_t get_series_count() const noexcept { return series_count; }
+
+    [[nodiscard]] static constexpr std::size_t series_count_for(std::size_t nest_count) noexcept {
+        return fixed_series_count + nest_count * 2;
+    }
+
+    // The bytes used by a history of the given number of nests, which doesn't grow as samples are recorded
+    [[nodiscard]] static constexpr std::size_t bytes_required(std::size_t nest_count) noexcept {
+        auto count = series_count_for(nest_count);
+
+        return count * capacity * sizeof(float) + count * sizeof(double);
+    }
+
+    // Adds the values of every series for one tick, in the order of the series
+    // A sample is only published once stride ticks have been recorded
+    void record(std::span<const float> values) noexcept;
+
+    // Copies every series into result, reusing its memory
+    void read(snapshot& result) const;
+};
+
+} // namespace ant_sim
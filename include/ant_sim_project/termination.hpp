@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "types.hpp"
+
+namespace ant_sim {
+
+class simulation;
+
+// Controls when a simulation stops before reaching its tick limit
+struct termination_policy {
+    // Stop once only queens are left and no nest has enough food for a new ant
+    // Only workers gather food, so such a colony can never grow again
+    bool stop_on_collapse = false;
+
+    // Stop once the population and the food count have stopped changing
+    // Each window of this many ticks is compared with the one before it, 0 disables the check
+    tick_t steady_state_window = 0;
+
+    // How much the mean and standard deviation of two windows may differ, relative to the mean, to count as steady
+    double steady_state_tolerance = 0.02;
+};
+
+enum class termination_reason : std::uint8_t {
+    none,        // The simulation hasn't terminated early
+    collapse,    // Only queens were left, and no nest could afford a new ant
+    steady_state // The population and food count stopped changing
+};
+
+[[nodiscard]] const char* to_string(termination_reason reason) noexcept;
+
+// Accumulates the mean and variance of a series of values, using Welford's algorithm
+struct running_stats {
+    std::size_t count = 0;
+    double mean = 0;
+    double m2 = 0; // The sum of squared differences from the mean
+
+    void add(double value) noexcept {
+        count++;
+
+        auto delta = value - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (value - mean);
+    }
+
+    [[nodiscard]] double variance() const noexcept { return count < 2 ? 0 : m2 / static_cast<double>(count - 1); }
+    [[nodiscard]] double standard_deviation() const noexcept;
+};
+
+// Watches a simulation after each tick for a reason to stop it early
+class termination_monitor {
+    termination_policy policy;
+
+    // The statistics of the current window, and of the one before it
+    running_stats population;
+    running_stats food;
+    running_stats previous_population;
+    running_stats previous_food;
+
+    [[nodiscard]] bool has_collapsed(const simulation& sim) const noexcept;
+    [[nodiscard]] bool is_steady(const simulation& sim) noexcept;
+
+  public:
+    termination_monitor() noexcept = default;
+    explicit termination_monitor(const termination_policy& policy) noexcept : policy{policy} {}
+
+    // Returns the reason the simulation should stop, if any
+    [[nodiscard]] termination_reason check(const simulation& sim) noexcept;
+};
+
+} // namespace ant_sim
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ant_sim {
+
+// Statistics for one nest, as of the end of the last tick
+struct nest_stats {
+    std::size_t population = 0; // Living ants, including the queen
+    std::size_t births = 0;     // Over the whole run
+    std::size_t deaths = 0;     // Over the whole run
+    double food_gathered = 0;   // Food taken from food sources by the nest's ants over the whole run
+};
+
+// The changes made during a single tick
+// The hot paths add to these plain counters instead of the simulation's atomics,
+// and the simulation publishes their totals once the tick has finished
+// Ticking ants on several threads would give each thread its own counters, merged before publishing
+struct tick_counters {
+    struct per_nest {
+        std::size_t population = 0; // Ants that survived the tick, not counting the ones born during it
+        std::size_t births = 0;
+        std::size_t deaths = 0;
+        double food_gathered = 0;
+    };
+
+    double food_change = 0; // The change in the food on the map
+    std::size_t births = 0;
+    std::size_t deaths = 0;
+
+    std::vector<per_nest> nests;
+
+    // Zeroes every counter, without releasing the memory for the nests
+    void reset(std::size_t nest_count) {
+        food_change = 0;
+        births = 0;
+        deaths = 0;
+
+        nests.assign(nest_count, {});
+    }
+
+    void merge(const tick_counters& other) noexcept {
+        food_change += other.food_change;
+        births += other.births;
+        deaths += other.deaths;
+
+        for(auto i = 0uz; i < nests.size(); i++) {
+            nests[i].population += other.nests[i].population;
+            nests[i].births += other.nests[i].births;
+            nests[i].deaths += other.nests[i].deaths;
+            nests[i].food_gathered += other.nests[i].food_gathered;
+        }
+    }
+
+    void record_survivor(nest_id_t nest_id) noexcept { nests[nest_id].population++; }
+
+    void record_birth(nest_id_t nest_id) noexcept {
+        births++;
+        nests[nest_id].births++;
+    }
+
+    void record_death(nest_id_t nest_id) noexcept {
+        deaths++;
+        nests[nest_id].deaths++;
+    }
+
+    void record_food_taken(nest_id_t nest_id, food_supply_t amount) noexcept {
+        food_change -= amount;
+        nests[nest_id].food_gathered += amount;
+    }
+
+    void record_food_resupplied(food_supply_t amount) noexcept { food_change += amount; }
+};
+
+} // namespace ant_sim
@@ -3,32 +3,72 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "pheromones.hpp"
 #include "types.hpp"
 
 namespace ant_sim {
 
 struct tile {
-    static constexpr std::size_t pheromone_type_count = 2;
+    static constexpr std::size_t pheromone_type_count = ant_sim::pheromone_type_count;
 
-    static constexpr nest_id_t max_nests = 20;
+    template <typename Encoding>
+    using basic_pheromone_trails = ant_sim::basic_pheromone_trails<Encoding>;
+    using pheromone_trails = basic_pheromone_trails<pheromone_encoding>;
 
-    // Using struct of arrays instead of array of structs decreases sizeof(tile)
-    struct pheromone_trails {
-        tick_t last_updated[max_nests][pheromone_type_count];
-        pheromone_strength_t pheromone_strength[max_nests][pheromone_type_count];
-    };
+    template <typename Encoding>
+    using basic_pheromone_pool = ant_sim::basic_pheromone_pool<Encoding>;
+    using pheromone_pool = basic_pheromone_pool<pheromone_encoding>;
 
-    ant_id_t ant_id;   // Meaningless if has_ant is false
-    nest_id_t nest_id; // Meaningless if has_nest is false
+    // Bits of flags
+    static constexpr std::uint8_t has_ant_flag = 1 << 0;
+    static constexpr std::uint8_t has_nest_flag = 1 << 1;
+    static constexpr std::uint8_t has_food_flag = 1 << 2;
 
-    bool has_ant;
-    bool has_nest;
+    // tile only holds what is needed to check whether a tile can be moved to, or what it contains
+    // This is checked for every neighbor of every ant, so it is kept small to fit more tiles per cache line
+    // Everything else is stored separately, in tile_contents
+
+    nest_id_t nest_id; // Meaningless if has_nest() is false
+    std::uint8_t flags;
+
+    [[nodiscard]] bool has_ant() const noexcept { return flags & has_ant_flag; }
+    [[nodiscard]] bool has_nest() const noexcept { return flags & has_nest_flag; }
+    // Matches whether the tile's food_supply is nonzero
+    // Chunked worlds keep their food outside of the tiles and never set it, so read food through the simulation
+    [[nodiscard]] bool has_food() const noexcept { return flags & has_food_flag; }
+
+    void set_has_ant(bool value) noexcept { set_flag(has_ant_flag, value); }
+    void set_has_nest(bool value) noexcept { set_flag(has_nest_flag, value); }
+    void set_has_food(bool value) noexcept { set_flag(has_food_flag, value); }
+
+    [[nodiscard]] bool is_full() const noexcept { return (flags & (has_ant_flag | has_nest_flag)) == has_ant_flag; }
+
+    // Returns a tile that is always full, for surrounding the world so that ants never move past its edges
+    [[nodiscard]] static tile make_border() noexcept {
+        tile result{};
+        result.set_has_ant(true);
+
+        return result;
+    }
+
+  private:
+    void set_flag(std::uint8_t flag, bool value) noexcept {
+        flags = static_cast<std::uint8_t>(value ? flags | flag : flags & ~flag);
+    }
+};
+
+// The parts of a tile that are only needed once an ant is moving to or from it, or when drawing it
+struct tile_contents {
+    ant_id_t ant_id; // Meaningless if the tile's has_ant() is false
 
     food_supply_t food_supply;
 
-    pheromone_trails pheromones;
+    tile::pheromone_trails pheromones;
 
-    [[nodiscard]] bool is_full() const noexcept { return !has_nest && has_ant; }
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    // A full precision copy of pheromones, used to measure how far the compact encoding drifts from it
+    tile::basic_pheromone_trails<exact_pheromone_encoding> exact_pheromones;
+#endif
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "types.hpp"
+
+namespace ant_sim {
+
+// World maps are binary files holding the starting layout of a world, which can be used instead of generating one
+// They are read by mapping the file into memory and using it in place, so even huge maps load without any parsing,
+// and every process using the same map shares the same pages
+//
+// A map is a world_map_header, followed by nest_count world_map_nest and then food_count world_map_food
+// Every value is little endian, and each part is aligned to its type when the file is mapped
+struct world_map_header {
+    char magic[8]; // "ANTMAP" followed by two zero bytes
+    std::uint32_t version;
+    std::uint32_t nest_count;
+    std::uint64_t rows;
+    std::uint64_t columns;
+    std::uint64_t food_count;
+    std::uint64_t checksum; // A 64 bit FNV-1a hash of everything after the header, which identifies the map
+};
+
+// Nests are given ids in the order they are stored
+struct world_map_nest {
+    std::uint32_t x;
+    std::uint32_t y;
+};
+
+// A tile that starts with food, which is also resupplied while the simulation runs
+struct world_map_food {
+    std::uint32_t x;
+    std::uint32_t y;
+    food_supply_t supply;
+};
+
+// A world map file, mapped read-only into memory
+// Throws std::runtime_error if the file can't be read or isn't a world map
+// The nests and food are only checked against the world's size once they are placed into a simulation
+class world_map {
+    std::filesystem::path path;
+
+    const std::byte* data = nullptr;
+    std::size_t size = 0;
+
+    // Holds the file's contents on platforms where it can't be mapped
+    std::vector<std::byte> contents;
+
+    [[nodiscard]] const world_map_header& get_header() const noexcept {
+        return *reinterpret_cast<const world_map_header*>(data);
+    }
+
+  public:
+    explicit world_map(const std::filesystem::path& path);
+
+    world_map(const world_map&) = delete;
+    world_map& operator=(const world_map&) = delete;
+
+    ~world_map();
+
+    [[nodiscard]] const std::filesystem::path& get_path() const noexcept { return path; }
+
+    [[nodiscard]] std::size_t get_rows() const noexcept { return get_header().rows; }
+    [[nodiscard]] std::size_t get_columns() const noexcept { return get_header().columns; }
+    [[nodiscard]] std::uint64_t get_checksum() const noexcept { return get_header().checksum; }
+
+    [[nodiscard]] std::span<const world_map_nest> get_nests() const noexcept;
+    [[nodiscard]] std::span<const world_map_food> get_food() const noexcept;
+};
+
+// Writes a world map file
+// Throws std::runtime_error if the file can't be written, there are more nests than nest ids,
+// or the world is too large for its locations to fit in 32 bits
+void write_world_map(const std::filesystem::path& path, std::size_t rows, std::size_t columns,
+                     std::span<const world_map_nest> nests, std::span<const world_map_food> food);
+
+} // namespace ant_sim
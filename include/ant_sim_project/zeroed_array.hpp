@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "arena.hpp"
+
+namespace ant_sim {
+
+// A fixed size array whose elements start out zeroed
+// The memory comes from an arena mapped directly from the OS, with pages that are already zero
+// Those pages are only touched when they are first written to, so creating a huge array is nearly free
+// T must be valid when all of its bytes are zero, and must not need its constructor or destructor to run
+template <typename T>
+    requires std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>
+class zeroed_array {
+    arena memory;
+    std::size_t count = 0;
+
+  public:
+    zeroed_array() noexcept = default;
+
+    explicit zeroed_array(std::size_t count, const arena_options& options = {})
+        : memory{count * sizeof(T), options}, count{count} {}
+
+    [[nodiscard]] T* data() noexcept { return std::launder(reinterpret_cast<T*>(memory.data())); }
+    [[nodiscard]] const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(memory.data())); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return count; }
+
+    [[nodiscard]] T& operator[](std::size_t i) noexcept { return data()[i]; }
+    [[nodiscard]] const T& operator[](std::size_t i) const noexcept { return data()[i]; }
+
+    [[nodiscard]] arena_stats memory_stats() const { return memory.stats(); }
+};
+
+} // namespace ant_sim
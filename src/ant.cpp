@@ -3,101 +3,98 @@
 #include "simulation.hpp"
 
 #include <array>
+#include <cmath>
 #include <optional>
 #include <ranges>
 #include <cassert>
+#include <utility>
 
 #include <print>
 
 namespace ant_sim {
 
-constexpr std::size_t max_neighbors = 8;
+// Stands in for neighbours past the edges of the world, when the tiles have no border to read instead
+static const tile out_of_bounds_tile = tile::make_border();
 
-// Return the neighboring points as an array of std::optional<point>
-// If the neighbor would have been out of bounds, that array element is std::nullopt
-constexpr auto get_neighbors(simulation& sim, point<> location) noexcept {
-    auto [x, y] = location;
+// Returns the tiles neighbouring location, in the order of neighbor_directions
+// Neighbours past the edges of the world read as full, so they are skipped along with every other full tile
+static std::array<const tile*, neighbor_count> get_neighbor_tiles(const simulation& sim, point<> location) noexcept {
+    std::array<const tile*, neighbor_count> neighbors;
 
-    std::array<std::optional<point<>>, max_neighbors> arr = {};
-
-    auto max_x = sim.get_tiles().extent(1) - 1;
-    auto max_y = sim.get_tiles().extent(0) - 1;
-
-    if(x != 0) {
-        if(y != 0) {
-            arr[0] = point{x - 1, y - 1};
-        }
-
-        arr[1] = point{x - 1, y};
-
-        if(y != max_y) {
-            arr[2] = point{x - 1, y + 1};
-        }
-    }
-
-    if(x != max_x) {
-        if(y != 0) {
-            arr[3] = point{x + 1, y - 1};
-        }
+    auto tiles = sim.get_tiles();
 
-        arr[4] = point{x + 1, y};
+#ifdef ANT_SIM_TILE_BORDER
+    // The border keeps every neighbour within the grid, so they are found with fixed offsets and no bounds checks
+    const auto* center = &tiles[location.y, location.x];
+    const auto& offsets = sim.get_tile_neighbor_offsets();
 
-        if(y != max_y) {
-            arr[5] = point{x + 1, y + 1};
-        }
+    for(auto i = 0uz; i < neighbor_count; i++) {
+        neighbors[i] = center + offsets[i];
     }
+#else
+    for(auto i = 0uz; i < neighbor_count; i++) {
+        // Stepping past 0 wraps around, so it is caught by the same comparison as stepping past the far edge
+        auto x = location.x + static_cast<std::size_t>(neighbor_directions[i].x);
+        auto y = location.y + static_cast<std::size_t>(neighbor_directions[i].y);
 
-    if(y != 0) {
-        arr[6] = point{x, y - 1};
-    }
+        auto in_bounds = x < tiles.extent(1) && y < tiles.extent(0);
 
-    if(y != max_y) {
-        arr[7] = point{x, y + 1};
+        neighbors[i] = in_bounds ? &tiles[y, x] : &out_of_bounds_tile;
     }
+#endif
 
-    return arr;
+    return neighbors;
 }
 
 // Move the ant to a new location
 // This updates the ant's location field, the has_ant field in the starting tile and destination tile
 // and updates the strength of the pheromone trails
-void ant::move(simulation& sim, point<> new_location) {
+void ant::move(simulation& sim, point<> new_location, tick_counters& counters) {
     assert(caste != caste::queen); // Queens should stay at their nest
 
     // Moving to the current location is a noop
     if(new_location == location) return;
 
     auto tiles = sim.get_tiles();
+    auto contents = sim.get_tile_contents();
 
     auto& current_tile = tiles[location.y, location.x];
     auto& new_tile = tiles[new_location.y, new_location.x];
 
+    auto& current_contents = contents[location.y, location.x];
+    auto& new_contents = contents[new_location.y, new_location.x];
+
     assert(!new_tile.is_full()); // Can't have multiple ants per tile unless the tile is a nest
 
+    // The ant leaves pheromones behind, and may take food from the new tile
+    sim.mark_dirty(location);
+    sim.mark_dirty(new_location);
+
     auto nests = sim.get_nests();
 
-    if(current_tile.has_nest && current_tile.nest_id == nest_id) {
+    if(current_tile.has_nest() && current_tile.nest_id == nest_id) {
         // Nests can hold multiple ants
         auto& nest = nests[current_tile.nest_id];
 
         assert(nest.ant_count != 0);
         if(--nest.ant_count == 0) {
-            current_tile.has_ant = false;
+            current_tile.set_has_ant(false);
         }
     } else {
-        current_tile.has_ant = false;
+        current_tile.set_has_ant(false);
     }
 
-    for(auto i = 0uz; i < tile::pheromone_type_count; i++) {
-        assert(new_tile.pheromones.last_updated[nest_id][i] == sim.get_tick_count());
-    }
     // Apply pheromone trails
-    current_tile.pheromones.pheromone_strength[nest_id][std::to_underlying(state)] += sim.increase_rate;
+    sim.deposit_pheromone(current_contents.pheromones, nest_id, std::to_underlying(state));
+
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    sim.deposit_pheromone(current_contents.exact_pheromones, nest_id, std::to_underlying(state));
+#endif
 
     // Add some food to the inventory, then set state to returning to nest
-    if(new_tile.food_supply != 0) {
+    if(auto food_supply = sim.get_food_supply(new_location); food_supply != 0) {
         // Ensure that we don't take more food than the tile contains
-        auto food_taken = std::min(sim.food_taken, new_tile.food_supply);
+        auto food_taken = std::min(sim.food_taken, food_supply);
 
         // The maximum amount of food this ant's inventory has room for
         food_supply_t max_food_taken = std::numeric_limits<food_supply_t>::max() - food_in_inventory;
@@ -105,10 +102,11 @@ void ant::move(simulation& sim, point<> new_location) {
         // Ensure that we don't take more food than this ant has room for
         food_taken = std::min(food_taken, max_food_taken);
 
-        new_tile.food_supply -= food_taken;
+        sim.set_food_supply(new_location, food_supply - food_taken);
+
         food_in_inventory += food_taken;
 
-        sim.set_food_count(sim.get_food_count() - food_taken);
+        counters.record_food_taken(nest_id, food_taken);
 
         state = state::returning;
 
@@ -119,7 +117,7 @@ void ant::move(simulation& sim, point<> new_location) {
 
     // Ant has returned to its nest
     // Deposit food in the nest, then set state to searching
-    if(new_tile.has_nest && new_tile.nest_id == nest_id) {
+    if(new_tile.has_nest() && new_tile.nest_id == nest_id) {
         auto& nest = nests[nest_id];
 
         // The maximum amount of food this nest's inventory has room for
@@ -141,33 +139,31 @@ void ant::move(simulation& sim, point<> new_location) {
         }
     }
 
-    new_tile.has_ant = true;
-    new_tile.ant_id = ant_id;
+    new_tile.set_has_ant(true);
+    new_contents.ant_id = ant_id;
 
     location = new_location;
 }
 
-// Calculate the weight for a tile, from the perspective of current_ant
-float ant::calculate_tile_weight(const tile& tile, simulation& sim) const noexcept {
+// Calculate the weight for a tile with the given pheromone strengths, from the perspective of current_ant
+float ant::calculate_tile_weight(const tile& tile, bool has_food, float type1_strength, float type2_strength,
+                                 simulation& sim) const noexcept {
     float multiplier = state == state::searching ? 1 : -1;
 
     // Tile has food
     // If searching, assign the highest possible weight to ensure that this tile is preferred
     // If returning, assign the lowest possible weight to ensure that this tile is avoided
-    if(tile.food_supply != 0) {
+    if(has_food) {
         return std::numeric_limits<float>::infinity() * multiplier;
     }
 
     // Tile is the ant's nest
     // If returning, assign the highest possible weight to ensure that this tile is preferred
     // If searching, assign the lowest possible weight to ensure that this tile is avoided
-    if(tile.has_nest && tile.nest_id == nest_id) {
+    if(tile.has_nest() && tile.nest_id == nest_id) {
         return -std::numeric_limits<float>::infinity() * multiplier;
     }
 
-    float type1_strength = tile.pheromones.pheromone_strength[nest_id][0];
-    float type2_strength = tile.pheromones.pheromone_strength[nest_id][1];
-
     // Apply some randomization to the pheromone strengths
     type1_strength += sim.add_dist(sim.rng);
     type2_strength += sim.add_dist(sim.rng);
@@ -186,39 +182,69 @@ float ant::calculate_tile_weight(const tile& tile, simulation& sim) const noexce
 
 // Returns the location this ant will move to, if such a location exists
 std::optional<point<>> ant::calculate_next_location(simulation& sim) {
-    auto tiles = sim.get_tiles();
+    // Choosing a tile only reads the world, so it goes through a const simulation
+    // This also stops a chunked world from allocating chunks just because an ant looked at them
+    const auto& world = std::as_const(sim);
 
-    auto neighboring_points = get_neighbors(sim, location);
+    auto tiles = world.get_tiles();
+    auto contents = world.get_tile_contents();
 
-    auto has_value = []<typename T>(const std::optional<T>& opt) { return opt.has_value(); };
+    auto neighbor_tiles = get_neighbor_tiles(sim, location);
 
-    auto current_tick = sim.get_tick_count();
+    auto has_value = []<typename T>(const std::optional<T>& opt) { return opt.has_value(); };
 
     struct result_t {
         point<> location;
         float weight;
     };
 
-    std::optional<result_t> results[max_neighbors] = {};
+    std::optional<result_t> results[neighbor_count] = {};
+
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    // The weights the tiles would have had with full precision pheromones
+    std::optional<float> exact_weights[neighbor_count] = {};
+#endif
 
     for(auto i = 0uz; i < std::size(results); i++) {
-        auto& neighbor = neighboring_points[i];
+        const auto& tile = *neighbor_tiles[i];
 
-        if(!neighbor) continue;
+        // Ignore tiles that are already full, including those past the edges of the world
+        // This only needs the tile itself, so the tile's contents aren't loaded for full tiles
+        if(tile.is_full()) continue;
 
-        auto& tile = tiles[neighbor->y, neighbor->x];
+        // Only tiles within the world can be empty, so the neighbour's contents exist
+        point<> neighbor = {location.x + static_cast<std::size_t>(neighbor_directions[i].x),
+                            location.y + static_cast<std::size_t>(neighbor_directions[i].y)};
 
-        // Ignore tiles that are already full
-        if(tile.is_full()) continue;
+        auto has_food = world.has_food(neighbor);
+
+        const auto& pheromones = contents[neighbor.y, neighbor.x].pheromones;
+
+        auto type1_strength = world.get_pheromone_strength(pheromones, nest_id, 0);
+        auto type2_strength = world.get_pheromone_strength(pheromones, nest_id, 1);
 
-        sim.update_pheromones(tile.pheromones, current_tick, nest_id);
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+        const auto& exact_pheromones = contents[neighbor.y, neighbor.x].exact_pheromones;
 
-        float weight = calculate_tile_weight(tile, sim);
+        auto exact_type1_strength = world.get_pheromone_strength(exact_pheromones, nest_id, 0);
+        auto exact_type2_strength = world.get_pheromone_strength(exact_pheromones, nest_id, 1);
 
-        results[i] = {.location = *neighbor, .weight = weight};
+        sim.pheromone_validation.record_strength_error(std::abs(type1_strength - exact_type1_strength));
+        sim.pheromone_validation.record_strength_error(std::abs(type2_strength - exact_type2_strength));
+
+        // Use a copy of the random number generator, so that both weights use the same random numbers
+        // The real weight is calculated afterwards with the original generator, so the run itself isn't affected
+        auto rng = sim.rng;
+        exact_weights[i] = calculate_tile_weight(tile, has_food, exact_type1_strength, exact_type2_strength, sim);
+        sim.rng = rng;
+#endif
+
+        float weight = calculate_tile_weight(tile, has_food, type1_strength, type2_strength, sim);
+
+        results[i] = {.location = neighbor, .weight = weight};
     }
 
-    // Exclude any out of bounds or full results
+    // Exclude any full results
     auto possible_results = results | std::views::filter(has_value);
 
     // All possible locations are full, no movement is possible
@@ -228,6 +254,19 @@ std::optional<point<>> ant::calculate_next_location(simulation& sim) {
 
     assert(!(tiles[new_location.y, new_location.x].is_full()));
 
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    // Find the location full precision pheromones would have chosen, breaking ties the same way max_element does
+    std::optional<std::size_t> exact_choice;
+
+    for(auto i = 0uz; i < std::size(exact_weights); i++) {
+        if(exact_weights[i] && (!exact_choice || *exact_weights[i] > *exact_weights[*exact_choice])) {
+            exact_choice = i;
+        }
+    }
+
+    sim.pheromone_validation.record_decision(results[*exact_choice]->location != new_location);
+#endif
+
     if(sim.get_log_ant_movements()) {
         std::println("Move,{},{},{},{}", ant_id, new_location.x, new_location.y, weight);
     }
@@ -239,7 +278,7 @@ std::optional<point<>> ant::calculate_next_location(simulation& sim) {
 // When the ant is searching for food it will avoid tiles with type 1 pheromones and prefer tiles with type 2 pheromones
 // It increases the strength of the type 1 pheromone on the tile it is leaving
 // When the ant is returning to the nest it behaves the same, but with its pheromone preferences flipped
-void ant::tick(simulation& sim) {
+void ant::tick(simulation& sim, tick_counters& counters) {
     switch(caste) {
     case caste::queen: {
         auto& nest = sim.get_nests()[nest_id];
@@ -267,26 +306,26 @@ void ant::tick(simulation& sim) {
         if(hunger >= sim.hunger_to_die) {
             auto& tile = sim.get_tiles()[location.y, location.x];
 
-            assert(tile.has_ant);
+            assert(tile.has_ant());
 
             // Mark ant as dead
             // It will be removed once this method returns
             dead = true;
 
             // Nests always have a queen, so has_ant  should never be set to false for a nest tile
-            if(!tile.has_nest) {
+            if(!tile.has_nest()) {
                 // Non nest tiles can only hold a single ant, so we can set has_ant to false here
-                tile.has_ant = false;
+                tile.set_has_ant(false);
             }
 
-            sim.increment_deaths();
+            counters.record_death(nest_id);
 
             return;
         }
 
         auto new_location = calculate_next_location(sim).value_or(location);
 
-        move(sim, new_location);
+        move(sim, new_location, counters);
 
         break;
     }
@@ -0,0 +1,64 @@
+// Generates a world the same way the simulation does, and saves its nests and food as a world map
+//
+// Usage: ant_sim_map_generator <output> <seed> [rows] [columns] [nests]
+// Large worlds take a while to generate, so generating them once and starting every run from the map saves that time
+// The map holds the same nests and food as a simulation created with the same seed and arguments, but a run started
+// from it won't play out the same way, as generating the world also advances the random number generator
+
+#include <ant_sim_project/simulation.hpp>
+#include <ant_sim_project/world_map.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <print>
+#include <string>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    if(argc < 3 || argc > 6) {
+        std::println("Usage: {} <output> <seed> [rows] [columns] [nests]", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ant_sim::simulation_args_t args = {};
+
+    try {
+        args.seed = std::stoull(argv[2]);
+
+        if(argc > 3) args.rows = std::stoull(argv[3]);
+        if(argc > 4) args.columns = std::stoull(argv[4]);
+        if(argc > 5) args.nest_count = static_cast<ant_sim::nest_id_t>(std::stoul(argv[5]));
+    } catch(...) {
+        std::println("Error parsing arguments");
+        return EXIT_FAILURE;
+    }
+
+    // Placing ants doesn't use the random number generator, so a single queen per nest gives the same layout
+    args.ant_count_per_nest = 1;
+
+    try {
+        ant_sim::simulation sim{args};
+
+        std::vector<ant_sim::world_map_nest> nests;
+        std::vector<ant_sim::world_map_food> food;
+
+        nests.reserve(sim.get_nests().size());
+        food.reserve(sim.get_food_sources().size());
+
+        for(const auto& nest : sim.get_nests()) {
+            nests.push_back({static_cast<std::uint32_t>(nest.location.x), static_cast<std::uint32_t>(nest.location.y)});
+        }
+
+        for(auto [x, y] : sim.get_food_sources()) {
+            food.push_back({static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y), sim.get_food_supply({x, y})});
+        }
+
+        ant_sim::write_world_map(argv[1], args.rows, args.columns, nests, food);
+
+        std::println("Map,{},{},{},{}", args.rows, args.columns, nests.size(), food.size());
+    } catch(const std::exception& e) {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -1,15 +1,38 @@
+// Runs the simulation in a window, or without one when passed --headless
+// ant_sim_headless is built from this file without the window, so that headless runs and frame export only need the
+// core, and every run it does is headless
+
+#ifdef ANT_SIM_HAS_WINDOW
 #include "ant_sim_project/gui.hpp"
+#include <ant_sim_project/graphics.hpp>
+#endif
 
 #include <ant_sim_project/simulation.hpp>
-#include <ant_sim_project/graphics.hpp>
+#include <ant_sim_project/scheduler.hpp>
+#include <ant_sim_project/replay.hpp>
+#include <ant_sim_project/frame_exporter.hpp>
+#include <ant_sim_project/delta_stream.hpp>
+#include <ant_sim_project/shared_snapshot.hpp>
 
+#include <cassert>
 #include <thread>
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <print>
 #include <span>
-
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef ANT_SIM_HAS_WINDOW
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
+#endif
 
 ant_sim::simulation_args_t parse_args(std::span<const char*> args) {
     assert(!args.empty());
@@ -72,46 +95,139 @@ ant_sim::simulation_args_t parse_args(std::span<const char*> args) {
     return result;
 }
 
-// Exit after this many ticks have passed
-ant_sim::tick_t max_ticks = 1200;
-
-int main(int argc, char* argv[]) {
-    for(int i = 0; i < argc; i++) {
-        std::print("{} ", argv[i]);
-    }
-    std::println("");
-
-    ant_sim::simulation_args_t args = {};
-
-    if(argc > 1) {
-        try {
-            args = parse_args(std::span{const_cast<const char**>(argv) + 1, static_cast<std::size_t>(argc - 1)});
-        } catch(...) {
-            std::println("Error parsing arguments");
-            return EXIT_FAILURE;
+// Options given by name, which can appear anywhere among the positional arguments
+struct options_t {
+    // Record a replay journal to this file
+    std::optional<std::string> record_path;
+
+    // Print a hash of the simulation's state every this many ticks
+    ant_sim::tick_t hash_interval = 0;
+
+    ant_sim::termination_policy termination = {};
+
+    // Run without a window, as fast as possible
+    bool headless = false;
+
+    // Write images of the world to this directory
+    std::optional<std::string> export_path;
+    ant_sim::frame_export_options export_options = {};
+
+    // Write the tiles changed by each tick to this file
+    std::optional<std::string> delta_path;
+
+    // Start from this world map instead of generating a world
+    std::optional<std::string> map_path;
+
+    // Publish snapshots of the world to this shared memory object
+    std::optional<std::string> snapshot_name;
+    ant_sim::snapshot_options snapshot_options = {};
+
+    // Controls the pages used for the tile grids
+    ant_sim::arena_options tile_memory = {};
+
+    // Sort the ants by location this often instead of the default
+    std::optional<ant_sim::tick_t> ant_sort_interval;
+
+    // Refuse to start if the simulation's estimated peak memory is above this many bytes, or never if 0
+    std::size_t memory_budget = 0;
+};
+
+// Moves the named options out of args into the returned options_t, leaving only the positional arguments
+options_t parse_options(std::vector<const char*>& args) {
+    options_t result = {};
+
+    std::vector<const char*> positional;
+
+    for(auto idx = 0uz; idx < args.size(); idx++) {
+        std::string_view arg = args[idx];
+
+        if(arg == "--record" && idx + 1 < args.size()) {
+            result.record_path = args[++idx];
+        } else if(arg == "--hash-every" && idx + 1 < args.size()) {
+            result.hash_interval = static_cast<ant_sim::tick_t>(std::stoul(args[++idx]));
+        } else if(arg == "--stop-on-collapse") {
+            result.termination.stop_on_collapse = true;
+        } else if(arg == "--steady-state-window" && idx + 1 < args.size()) {
+            result.termination.steady_state_window = static_cast<ant_sim::tick_t>(std::stoul(args[++idx]));
+        } else if(arg == "--steady-state-tolerance" && idx + 1 < args.size()) {
+            result.termination.steady_state_tolerance = std::stod(args[++idx]);
+        } else if(arg == "--memory-budget" && idx + 1 < args.size()) {
+            // Given in MiB
+            result.memory_budget = std::stoull(args[++idx]) << 20;
+        } else if(arg == "--huge-pages") {
+            result.tile_memory.explicit_huge_pages = true;
+        } else if(arg == "--first-touch-threads" && idx + 1 < args.size()) {
+            result.tile_memory.first_touch_threads = static_cast<unsigned>(std::stoul(args[++idx]));
+        } else if(arg == "--sort-ants-every" && idx + 1 < args.size()) {
+            result.ant_sort_interval = static_cast<ant_sim::tick_t>(std::stoul(args[++idx]));
+        } else if(arg == "--delta-stream" && idx + 1 < args.size()) {
+            result.delta_path = args[++idx];
+        } else if(arg == "--snapshot" && idx + 1 < args.size()) {
+            result.snapshot_name = args[++idx];
+        } else if(arg == "--snapshot-every" && idx + 1 < args.size()) {
+            result.snapshot_options.interval = static_cast<ant_sim::tick_t>(std::stoul(args[++idx]));
+        } else if(arg == "--snapshot-ants" && idx + 1 < args.size()) {
+            result.snapshot_options.ant_capacity = std::stoull(args[++idx]);
+        } else if(arg == "--snapshot-pheromones" && idx + 1 < args.size()) {
+            // A comma separated list of <nest>:<type>
+            std::string_view planes = args[++idx];
+
+            while(!planes.empty()) {
+                auto plane = planes.substr(0, planes.find(','));
+                auto colon = plane.find(':');
+
+                if(colon == std::string_view::npos) throw std::invalid_argument{"malformed pheromone plane"};
+
+                result.snapshot_options.pheromone_planes.push_back(
+                    {static_cast<std::uint32_t>(std::stoul(std::string{plane.substr(0, colon)})),
+                     static_cast<std::uint32_t>(std::stoul(std::string{plane.substr(colon + 1)}))});
+
+                planes.remove_prefix(std::min(plane.size() + 1, planes.size()));
+            }
+        } else if(arg == "--map" && idx + 1 < args.size()) {
+            result.map_path = args[++idx];
+        } else if(arg == "--headless") {
+            result.headless = true;
+        } else if(arg == "--export-frames" && idx + 1 < args.size()) {
+            result.export_path = args[++idx];
+        } else if(arg == "--export-every" && idx + 1 < args.size()) {
+            result.export_options.interval = static_cast<ant_sim::tick_t>(std::stoul(args[++idx]));
+        } else if(arg == "--export-format" && idx + 1 < args.size()) {
+            std::string_view format = args[++idx];
+
+            if(format == "ppm") {
+                result.export_options.format = ant_sim::image_format::ppm;
+            } else if(format == "png") {
+                result.export_options.format = ant_sim::image_format::png;
+            } else {
+                throw std::invalid_argument{"unknown image format"};
+            }
+        } else if(arg == "--export-nest" && idx + 1 < args.size()) {
+            result.export_options.pheromone_nest_id = static_cast<ant_sim::nest_id_t>(std::stoul(args[++idx]));
+        } else if(arg == "--export-pheromone-type" && idx + 1 < args.size()) {
+            result.export_options.pheromone_type = std::stoul(args[++idx]);
+        } else if(arg == "--export-threads" && idx + 1 < args.size()) {
+            result.export_options.thread_count = static_cast<unsigned>(std::stoul(args[++idx]));
+        } else {
+            positional.push_back(args[idx]);
         }
     }
 
-    ant_sim::simulation_mutex sim{args};
-
-    std::jthread simulation_thread{[](const std::stop_token& stop_token, ant_sim::simulation_mutex& sim) {
-        while(!sim.stopped() && !stop_token.stop_requested()) {
-            auto locked_sim = sim.lock();
+    args = std::move(positional);
 
-            if(locked_sim->get_tick_count() > max_ticks) {
-                sim.stop();
-                break;
-            }
-
-            locked_sim->tick();
-
-            auto sleep_time = locked_sim->sleep_time;
+    return result;
+}
 
-            locked_sim.unlock();
+// Exit after this many ticks have passed
+ant_sim::tick_t max_ticks = 1200;
 
-            std::this_thread::sleep_for(sleep_time);
-        }
-    }, std::ref(sim)};
+#ifdef ANT_SIM_HAS_WINDOW
+// Shows the simulation in a window while it runs on another thread, until either the window is closed or it stops
+void run_window(ant_sim::simulation_mutex& sim, ant_sim::replay_recorder* recorder,
+                ant_sim::frame_exporter* exporter, ant_sim::delta_writer* deltas,
+                ant_sim::snapshot_publisher* snapshots) {
+    std::jthread simulation_thread{ant_sim::run_simulation, std::ref(sim), max_ticks, recorder, exporter, deltas,
+                                   snapshots};
 
     // The default values for window width and height
     sf::Vector2u default_window_dimensions = {800, 600};
@@ -195,7 +311,193 @@ int main(int argc, char* argv[]) {
 
         window.display();
     }
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    for(int i = 0; i < argc; i++) {
+        std::print("{} ", argv[i]);
+    }
+    std::println("");
+
+    ant_sim::simulation_args_t args = {};
+    options_t options = {};
+
+    try {
+        std::vector<const char*> positional_args(argv + 1, argv + argc);
+
+        options = parse_options(positional_args);
+
+#ifndef ANT_SIM_HAS_WINDOW
+        options.headless = true;
+#endif
+
+        if(!positional_args.empty()) {
+            args = parse_args(positional_args);
+        }
+
+        args.termination = options.termination;
+        args.tile_memory = options.tile_memory;
+
+        if(options.ant_sort_interval) args.ant_sort_interval = *options.ant_sort_interval;
+
+        // The map decides the size of the world and the number of nests, so any given as arguments are replaced
+        if(options.map_path) {
+            args.map = std::make_shared<const ant_sim::world_map>(*options.map_path);
+            args.rows = args.map->get_rows();
+            args.columns = args.map->get_columns();
+            args.nest_count = static_cast<ant_sim::nest_id_t>(args.map->get_nests().size());
+        }
+
+        if(options.export_options.pheromone_nest_id >= args.nest_count ||
+           options.export_options.pheromone_type >= ant_sim::tile::pheromone_type_count) {
+            throw std::invalid_argument{"no such pheromone trail"};
+        }
+    } catch(const std::runtime_error& e) {
+        // The world map couldn't be read
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    } catch(...) {
+        std::println("Error parsing arguments");
+        return EXIT_FAILURE;
+    }
+
+    // Checked before creating the simulation, as large worlds can run out of memory partway through creating it
+    auto estimated_memory = ant_sim::simulation::estimate_memory_usage(args);
+
+    std::println("MemoryEstimate,{}", estimated_memory.total());
+
+    // Shared snapshots hold two copies of the world outside of the simulation, so they count towards the budget too
+    std::size_t snapshot_bytes = 0;
+
+    if(options.snapshot_name) {
+        snapshot_bytes = ant_sim::snapshot_publisher::bytes_required(options.snapshot_options, args);
+
+        std::println("SnapshotMemory,{}", snapshot_bytes);
+    }
+
+    if(options.memory_budget != 0 && estimated_memory.total() + snapshot_bytes > options.memory_budget) {
+        std::println("Error: the estimated peak memory of {} bytes is over the budget of {} bytes",
+                     estimated_memory.total() + snapshot_bytes, options.memory_budget);
+        return EXIT_FAILURE;
+    }
+
+    ant_sim::simulation_mutex sim{args};
+
+    sim.lock()->hash_interval = options.hash_interval;
+
+    std::unique_ptr<ant_sim::replay_recorder> recorder;
+
+    if(options.record_path) {
+        try {
+            recorder = std::make_unique<ant_sim::replay_recorder>(*options.record_path, *sim.lock(), args);
+        } catch(const std::exception& e) {
+            std::println("{}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::unique_ptr<ant_sim::frame_exporter> exporter;
+
+    if(options.export_path) {
+        try {
+            options.export_options.directory = *options.export_path;
+
+            exporter = std::make_unique<ant_sim::frame_exporter>(options.export_options);
+        } catch(const std::exception& e) {
+            std::println("{}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::unique_ptr<ant_sim::delta_writer> deltas;
+
+    if(options.delta_path) {
+        try {
+            deltas = std::make_unique<ant_sim::delta_writer>(*options.delta_path, *sim.lock());
+        } catch(const std::exception& e) {
+            std::println("{}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::unique_ptr<ant_sim::snapshot_publisher> snapshots;
+
+    if(options.snapshot_name) {
+        try {
+            options.snapshot_options.name = *options.snapshot_name;
+
+            snapshots = std::make_unique<ant_sim::snapshot_publisher>(options.snapshot_options, *sim.lock());
+        } catch(const std::exception& e) {
+            std::println("{}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
+    if(options.headless) {
+        sim.lock()->run_unlimited = true;
+
+        ant_sim::run_simulation(std::stop_token{}, sim, max_ticks, recorder.get(), exporter.get(), deltas.get(),
+                                snapshots.get());
+    } else {
+#ifdef ANT_SIM_HAS_WINDOW
+        run_window(sim, recorder.get(), exporter.get(), deltas.get(), snapshots.get());
+#endif
+    }
+
+    if(exporter) {
+        exporter->finish();
+
+        std::println("Frames,{},{}", exporter->get_frames_written(), exporter->get_frames_dropped());
+    }
+
+    if(deltas) {
+        std::println("Deltas,{},{}", deltas->get_ticks_written(), deltas->get_bytes_written());
+    }
+
+    if(snapshots) {
+        std::println("Snapshots,{}", snapshots->get_snapshots_published());
+    }
+
+    auto tile_memory = sim.lock()->get_tile_memory_stats();
+    std::println("TileMemory,{},{},{},{}", ant_sim::to_string(tile_memory.kind), tile_memory.size,
+                 tile_memory.resident_bytes, tile_memory.huge_page_bytes);
+
+    // Each part's live memory, followed by its estimated peak
+    auto memory = sim.lock()->get_memory_usage();
+
+    for(const auto& [name, member] : ant_sim::memory_components) {
+        std::println("Memory,{},{},{}", name, memory.*member, estimated_memory.*member);
+    }
+
+    std::println("Memory,total,{},{}", memory.total(), estimated_memory.total());
+
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    auto validation = sim.lock()->pheromone_validation;
+    std::println("PheromoneDrift,{},{},{},{}", validation.decisions, validation.divergent_decisions,
+                 validation.mean_strength_error(), validation.max_strength_error);
+#endif
+
+    // Runs that stopped early report why and when, otherwise the reason is none and the tick is the final tick count
+    auto termination_reason = sim.lock()->get_termination_reason();
+    auto termination_tick = sim.lock()->get_termination_tick();
+
+    if(termination_reason == ant_sim::termination_reason::none) {
+        termination_tick = sim.get_tick_count();
+    }
+
+    std::println("Termination,{},{}", ant_sim::to_string(termination_reason), termination_tick);
 
     std::println("TotalBirths,{}", sim.lock()->get_births());
     std::println("TotalDeaths,{}", sim.lock()->get_deaths());
+
+    auto locked_sim = sim.lock();
+    auto nest_stats = locked_sim->get_nest_stats();
+
+    for(auto nest_id = 0uz; nest_id < nest_stats.size(); nest_id++) {
+        const auto& stats = nest_stats[nest_id];
+
+        std::println("NestStats,{},{},{},{},{}", nest_id, stats.population, stats.births, stats.deaths,
+                     stats.food_gathered);
+    }
 }
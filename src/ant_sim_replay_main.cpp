@@ -0,0 +1,56 @@
+// Re-runs a replay journal recorded with --record, without a window and as fast as possible
+//
+// Usage: ant_sim_replay <journal> [--hash-every <ticks>]
+// The output is the same log the recorded run printed, so the two can be compared directly
+
+#include <ant_sim_project/simulation.hpp>
+#include <ant_sim_project/replay.hpp>
+
+#include <cstdlib>
+#include <exception>
+#include <print>
+#include <string>
+#include <string_view>
+
+int main(int argc, char* argv[]) {
+    if(argc != 2 && !(argc == 4 && argv[2] == std::string_view{"--hash-every"})) {
+        std::println("Usage: {} <journal> [--hash-every <ticks>]", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto journal = ant_sim::read_journal(argv[1]);
+
+        auto end_tick = journal.end_tick.value_or(0);
+
+        if(!journal.end_tick) {
+            // Without an End record, the best that can be done is to run up to the last recorded change
+            if(!journal.changes.empty()) end_tick = journal.changes.back().tick;
+
+            std::println("Warning: the journal has no End record, replaying up to tick {}", end_tick);
+        }
+
+        ant_sim::simulation sim{journal.args};
+
+        if(argc == 4) {
+            sim.hash_interval = static_cast<ant_sim::tick_t>(std::stoul(argv[3]));
+        }
+
+        ant_sim::replay(sim, journal, end_tick);
+
+        std::println("TotalBirths,{}", sim.get_births());
+        std::println("TotalDeaths,{}", sim.get_deaths());
+
+        auto nest_stats = sim.get_nest_stats();
+
+        for(auto nest_id = 0uz; nest_id < nest_stats.size(); nest_id++) {
+            const auto& stats = nest_stats[nest_id];
+
+            std::println("NestStats,{},{},{},{},{}", nest_id, stats.population, stats.births, stats.deaths,
+                         stats.food_gathered);
+        }
+    } catch(const std::exception& e) {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
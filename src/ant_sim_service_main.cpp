@@ -0,0 +1,506 @@
+// Runs simulations for other programs, so that many small runs don't each pay for starting a process
+//
+// Usage: ant_sim_service <socket> [--threads <count>] [--memory-budget <MiB>] [--huge-pages]
+//                        [--first-touch-threads <count>]
+// Listens on a Unix domain socket, and runs the requests of every client on a pool of worker threads
+// Clients take turns, so one client queueing thousands of runs doesn't hold up the others
+// Clients that stop reading their responses are disconnected, so a stalled client can't hold up the workers
+// The runs in progress are kept within the memory budget, which defaults to the machine's physical memory
+// Runs estimated to need more than the whole budget are refused, and the rest wait until enough of it is free
+// The protocol is described in service_protocol.hpp
+// Runs until interrupted, then finishes the runs in progress, removes the socket and prints a Runs,finished,failed line
+
+#include <ant_sim_project/simulation.hpp>
+#include <ant_sim_project/service_protocol.hpp>
+#include <ant_sim_project/world_map.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <format>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define ANT_SIM_HAS_UNIX_SOCKETS
+#endif
+
+#ifdef ANT_SIM_HAS_UNIX_SOCKETS
+
+namespace {
+
+using namespace ant_sim;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+extern "C" void request_stop(int) { stop_requested = 1; }
+
+// How long a client has to make room for more of a response before it is dropped
+// Without a limit, a client that stops reading would hold up the worker answering it for as long as it stays connected
+constexpr timeval send_timeout = {.tv_sec = 5, .tv_usec = 0};
+
+// Requests are short, so a client sending a longer line without a newline is disconnected rather than buffered
+constexpr std::size_t max_request_length = 64 * 1024;
+
+// A connected client
+// Workers answer on the connection's socket, which stays open until every run holding it has finished
+class connection {
+    int fd;
+
+    std::mutex write_mutex;
+
+    // Set once a response couldn't be sent in time, after which nothing more is sent
+    bool dropped = false;
+
+  public:
+    // Set once the client has disconnected, and its reader has stopped
+    std::atomic<bool> disconnected = false;
+
+    explicit connection(int fd) noexcept : fd{fd} {
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    }
+
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
+
+    ~connection() { close(fd); }
+
+    [[nodiscard]] int get_fd() const noexcept { return fd; }
+
+    // Writes a whole response, so that responses from different workers don't interleave
+    // Responses to clients that have gone away are dropped
+    // A client that doesn't read for send_timeout is disconnected, as the response it was sent has been cut short
+    void send(std::span<const std::uint8_t> bytes) {
+        std::scoped_lock lock{write_mutex};
+
+        while(!bytes.empty() && !dropped) {
+            auto written = write(fd, bytes.data(), bytes.size());
+
+            if(written < 0 && errno == EINTR) continue;
+
+            if(written <= 0) {
+                // Also wakes up the client's reader, which then cancels its queued runs
+                shutdown(fd, SHUT_RDWR);
+                dropped = true;
+                return;
+            }
+
+            bytes = bytes.subspan(static_cast<std::size_t>(written));
+        }
+    }
+};
+
+struct job {
+    std::shared_ptr<connection> client;
+    run_request request;
+};
+
+// Queues runs for the workers, taking one run from each client with queued runs in turn
+class run_queue {
+    std::mutex mutex;
+    std::condition_variable ready;
+
+    // The clients with queued runs, in the order they take their turns
+    std::deque<std::shared_ptr<connection>> turns;
+    std::unordered_map<const connection*, std::deque<run_request>> pending;
+
+    bool stopping = false;
+
+  public:
+    void push(const std::shared_ptr<connection>& client, run_request request) {
+        {
+            std::scoped_lock lock{mutex};
+
+            auto& queued = pending[client.get()];
+
+            if(queued.empty()) turns.push_back(client);
+
+            queued.push_back(std::move(request));
+        }
+
+        ready.notify_one();
+    }
+
+    // Drops the runs a client queued but that haven't started, as nobody is left to read their results
+    void cancel(const connection& client) {
+        std::scoped_lock lock{mutex};
+
+        pending.erase(&client);
+        std::erase_if(turns, [&](const auto& turn) { return turn.get() == &client; });
+    }
+
+    // Waits for a run, and returns nothing once the queue has been stopped
+    [[nodiscard]] std::optional<job> pop() {
+        std::unique_lock lock{mutex};
+
+        ready.wait(lock, [&] { return stopping || !turns.empty(); });
+
+        if(stopping) return {};
+
+        auto client = std::move(turns.front());
+        turns.pop_front();
+
+        auto& queued = pending[client.get()];
+
+        job next{client, std::move(queued.front())};
+        queued.pop_front();
+
+        // Clients with more runs go to the back of the line
+        if(queued.empty()) {
+            pending.erase(client.get());
+        } else {
+            turns.push_back(client);
+        }
+
+        return next;
+    }
+
+    void stop() {
+        {
+            std::scoped_lock lock{mutex};
+            stopping = true;
+        }
+
+        ready.notify_all();
+    }
+};
+
+// Keeps the estimated peak memory of the runs in progress within a budget, shared by every client
+class memory_budget {
+    std::mutex mutex;
+    std::condition_variable freed;
+
+    std::size_t budget;
+    std::size_t reserved = 0;
+
+  public:
+    // Holds part of the budget until it is destroyed
+    class reservation {
+        memory_budget& owner;
+        std::size_t bytes;
+
+      public:
+        reservation(memory_budget& owner, std::size_t bytes) : owner{owner}, bytes{bytes} {
+            std::unique_lock lock{owner.mutex};
+
+            owner.freed.wait(lock, [&] { return owner.reserved + bytes <= owner.budget; });
+            owner.reserved += bytes;
+        }
+
+        reservation(const reservation&) = delete;
+        reservation& operator=(const reservation&) = delete;
+
+        ~reservation() {
+            {
+                std::scoped_lock lock{owner.mutex};
+                owner.reserved -= bytes;
+            }
+
+            owner.freed.notify_all();
+        }
+    };
+
+    explicit memory_budget(std::size_t budget) noexcept : budget{budget} {}
+
+    // Throws std::runtime_error if a run estimated to need bytes could never fit within the budget
+    void check(std::size_t bytes) const {
+        if(bytes > budget) {
+            throw std::runtime_error{
+                std::format("Error: the estimated peak memory of {} bytes is over the budget of {} bytes", bytes,
+                            budget)};
+        }
+    }
+};
+
+// The machine's physical memory, or no limit if it can't be found
+std::size_t physical_memory() {
+    auto pages = sysconf(_SC_PHYS_PAGES);
+    auto page_size = sysconf(_SC_PAGE_SIZE);
+
+    if(pages <= 0 || page_size <= 0) return std::numeric_limits<std::size_t>::max();
+
+    return static_cast<std::size_t>(pages) * static_cast<std::size_t>(page_size);
+}
+
+// Keeps every world map that has been asked for, so that runs from the same map share its pages
+// Maps are only read once, so a map changed while the service runs isn't seen until it restarts
+class map_cache {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<const world_map>> maps;
+
+  public:
+    [[nodiscard]] std::shared_ptr<const world_map> get(const std::filesystem::path& path) {
+        std::scoped_lock lock{mutex};
+
+        auto& map = maps[path.string()];
+
+        if(!map) map = std::make_shared<const world_map>(path);
+
+        return map;
+    }
+};
+
+std::atomic<std::size_t> finished_runs = 0;
+std::atomic<std::size_t> failed_runs = 0;
+
+std::vector<std::uint8_t> run(const run_request& request, const arena_options& tile_memory, memory_budget& memory) {
+    try {
+        auto args = request.args;
+        args.tile_memory = tile_memory;
+
+        // Waits for the runs in progress to free enough of the budget
+        memory_budget::reservation reserved{memory, simulation::estimate_memory_usage(args).total()};
+
+        // Nothing a run logs is read, and the service's output would otherwise grow with every run
+        args.log_events = false;
+
+        simulation sim{args};
+
+        sim.set_log_ant_state_changes(false);
+
+        while(sim.get_tick_count() < request.max_ticks && !sim.stopped()) {
+            sim.tick();
+        }
+
+        finished_runs++;
+
+        return encode_run_response(request.id, request.metrics, sim);
+    } catch(const std::exception& e) {
+        failed_runs++;
+
+        return encode_error_response(request.id, e.what());
+    }
+}
+
+// Reads the client's requests until it disconnects, queueing the valid ones and answering the rest with errors
+void read_requests(const std::shared_ptr<connection>& client, run_queue& queue, map_cache& maps,
+                   const memory_budget& memory) {
+    std::string buffered;
+    char chunk[4096];
+
+    auto handle = [&](std::string_view line) {
+        if(line.ends_with('\r')) line.remove_suffix(1);
+        if(line.empty()) return;
+
+        run_request request;
+
+        try {
+            parse_run_request(line, request);
+
+            if(request.map_path) request.args.map = maps.get(*request.map_path);
+
+            // Refused now, as waiting for memory to be freed would never let it run
+            memory.check(simulation::estimate_memory_usage(request.args).total());
+
+            queue.push(client, std::move(request));
+        } catch(const std::exception& e) {
+            failed_runs++;
+            client->send(encode_error_response(request.id, e.what()));
+        }
+    };
+
+    while(true) {
+        auto bytes_read = read(client->get_fd(), chunk, sizeof(chunk));
+
+        if(bytes_read < 0 && errno == EINTR) continue;
+        if(bytes_read <= 0) break;
+
+        buffered.append(chunk, static_cast<std::size_t>(bytes_read));
+
+        auto line_start = 0uz;
+
+        for(auto newline = buffered.find('\n'); newline != std::string::npos;
+            newline = buffered.find('\n', line_start)) {
+            handle(std::string_view{buffered}.substr(line_start, newline - line_start));
+            line_start = newline + 1;
+        }
+
+        buffered.erase(0, line_start);
+
+        if(buffered.size() > max_request_length) {
+            failed_runs++;
+            client->send(encode_error_response(0, "Error: the request is too long"));
+
+            shutdown(client->get_fd(), SHUT_RDWR);
+            break;
+        }
+    }
+
+    queue.cancel(*client);
+    client->disconnected = true;
+}
+
+// Creates a listening socket at path, replacing a socket left behind by an earlier run
+int listen_at(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if(path.size() >= sizeof(address.sun_path)) throw std::runtime_error{"Error: the socket path is too long"};
+
+    path.copy(address.sun_path, path.size());
+
+    // Only sockets are replaced, so a mistyped path can't delete some other file
+    if(struct stat existing{}; lstat(path.c_str(), &existing) == 0) {
+        if(!S_ISSOCK(existing.st_mode)) throw std::runtime_error{"Error: " + path + " exists and isn't a socket"};
+
+        unlink(path.c_str());
+    }
+
+    auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd < 0) throw std::runtime_error{"Error: could not create a socket"};
+
+    if(bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        throw std::runtime_error{"Error: could not listen on " + path};
+    }
+
+    return fd;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(argc < 2) {
+        std::println("Usage: {} <socket> [--threads <count>] [--memory-budget <MiB>] [--huge-pages] "
+                     "[--first-touch-threads <count>]",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string socket_path = argv[1];
+    unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Applied to every run, as clients can't know what the machine running the service supports
+    arena_options tile_memory = {};
+    std::size_t memory_budget_bytes = physical_memory();
+
+    try {
+        for(auto idx = 2; idx < argc; idx++) {
+            std::string_view arg = argv[idx];
+
+            auto has_value = idx + 1 < argc;
+
+            if(arg == "--threads" && has_value) {
+                thread_count = std::max(static_cast<unsigned>(std::stoul(argv[++idx])), 1u);
+            } else if(arg == "--memory-budget" && has_value) {
+                // Given in MiB
+                memory_budget_bytes = std::stoull(argv[++idx]) << 20;
+            } else if(arg == "--huge-pages") {
+                tile_memory.explicit_huge_pages = true;
+            } else if(arg == "--first-touch-threads" && has_value) {
+                tile_memory.first_touch_threads = static_cast<unsigned>(std::stoul(argv[++idx]));
+            } else {
+                throw std::invalid_argument{"unknown argument"};
+            }
+        }
+    } catch(...) {
+        std::println("Error parsing arguments");
+        return EXIT_FAILURE;
+    }
+
+    // Clients that disconnect before their results are sent would otherwise end the service
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    int listen_fd = -1;
+
+    try {
+        listen_fd = listen_at(socket_path);
+    } catch(const std::exception& e) {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+
+    std::println("Service,{},{}", socket_path, thread_count);
+
+    run_queue queue;
+    map_cache maps;
+    memory_budget memory{memory_budget_bytes};
+
+    // The workers stay running between runs, so a run only pays for creating its world
+    std::vector<std::jthread> workers;
+    workers.reserve(thread_count);
+
+    for(auto i = 0u; i < thread_count; i++) {
+        workers.emplace_back([&] {
+            while(auto next = queue.pop()) {
+                next->client->send(run(next->request, tile_memory, memory));
+            }
+        });
+    }
+
+    struct client_reader {
+        std::shared_ptr<connection> client;
+        std::jthread thread;
+    };
+
+    std::vector<client_reader> readers;
+
+    while(!stop_requested) {
+        // Wakes up regularly to check for a stop request, as signals don't reliably interrupt poll
+        pollfd listening{.fd = listen_fd, .events = POLLIN, .revents = 0};
+
+        if(poll(&listening, 1, 250) <= 0) continue;
+
+        auto client_fd = accept(listen_fd, nullptr, nullptr);
+
+        if(client_fd < 0) continue;
+
+        // Readers of clients that have gone away are joined, so they don't pile up
+        std::erase_if(readers, [](const auto& reader) { return reader.client->disconnected.load(); });
+
+        auto client = std::make_shared<connection>(client_fd);
+
+        readers.push_back({client, std::jthread{read_requests, client, std::ref(queue), std::ref(maps),
+                                                  std::cref(memory)}});
+    }
+
+    close(listen_fd);
+    unlink(socket_path.c_str());
+
+    // Stop reading requests, then let the workers finish the runs they are on
+    for(auto& reader : readers) {
+        shutdown(reader.client->get_fd(), SHUT_RD);
+    }
+
+    readers.clear();
+
+    queue.stop();
+    workers.clear();
+
+    std::println("Runs,{},{}", finished_runs.load(), failed_runs.load());
+}
+
+#else
+
+int main() {
+    std::println("Error: ant_sim_service needs Unix domain sockets, which aren't available on this platform");
+    return EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,188 @@
+// Runs a parameter sweep without a window, reusing the results of runs that have already been done
+//
+// Usage: ant_sim_sweep <cache> <parameter> <values...> [--seeds <count>] [--ticks <ticks>] [--threads <count>]
+//                      [--rows <rows>] [--columns <columns>] [--nests <nests>] [--ants <ants per nest>]
+//                      [--map <file>] [--huge-pages] [--first-touch-threads <count>]
+// Every value is run once with each of the seeds 0 to count - 1, and the results are stored in the cache file
+// With a map, every run starts from the map's world, which is loaded once and shared by all of them
+// Runs already in the cache aren't run again, so adding a value only runs the new value, and a sweep that crashed
+// picks up where it left off
+
+#include <ant_sim_project/simulation.hpp>
+#include <ant_sim_project/ensemble.hpp>
+#include <ant_sim_project/result_cache.hpp>
+#include <ant_sim_project/world_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace ant_sim;
+
+struct swept_parameter {
+    const char* name;
+    float simulation_args_t::* member;
+};
+
+// The arguments that can be swept, named like the tunable parameters
+// clang-format off
+constexpr swept_parameter swept_parameters[] = {
+    {"hunger_increase_per_tick", &simulation_args_t::hunger_increase_per_tick},
+    {"hunger_to_die", &simulation_args_t::hunger_to_die},
+    {"food_taken", &simulation_args_t::food_taken},
+    {"food_resupply_rate", &simulation_args_t::food_resupply_rate},
+    {"max_food_supply", &simulation_args_t::max_food_supply},
+    {"food_per_new_ant", &simulation_args_t::food_per_new_ant},
+    {"food_hunger_ratio", &simulation_args_t::food_hunger_ratio},
+    {"falloff_rate", &simulation_args_t::falloff_rate},
+    {"increase_rate", &simulation_args_t::increase_rate},
+    {"type1_avoidance", &simulation_args_t::type1_avoidance},
+    {"type2_avoidance", &simulation_args_t::type2_avoidance}
+};
+// clang-format on
+
+const swept_parameter& find_parameter(std::string_view name) {
+    for(const auto& parameter : swept_parameters) {
+        if(name == parameter.name) return parameter;
+    }
+
+    throw std::invalid_argument{"unknown parameter"};
+}
+
+void print_result(std::string_view parameter, float value, std::uint64_t seed, bool cached,
+                  const run_summary& summary) {
+    std::println("Result,{},{},{},{},{},{},{},{},{},{}", parameter, value, seed, cached ? 1 : 0, summary.ticks,
+                 to_string(summary.termination), summary.ant_count, summary.food_count, summary.births,
+                 summary.deaths);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(argc < 4) {
+        std::println("Usage: {} <cache> <parameter> <values...> [--seeds <count>] [--ticks <ticks>] "
+                     "[--threads <count>] [--rows <rows>] [--columns <columns>] [--nests <nests>] "
+                     "[--ants <ants per nest>] [--map <file>] [--huge-pages] [--first-touch-threads <count>]",
+                     argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    simulation_args_t args = {};
+    const swept_parameter* parameter = nullptr;
+    std::vector<float> values;
+
+    std::uint64_t seed_count = 4;
+    tick_t max_ticks = 1200;
+    unsigned thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::optional<std::string> map_path;
+
+    try {
+        parameter = &find_parameter(argv[2]);
+
+        for(auto idx = 3; idx < argc; idx++) {
+            std::string_view arg = argv[idx];
+
+            auto has_value = idx + 1 < argc;
+
+            if(arg == "--seeds" && has_value) {
+                seed_count = std::stoull(argv[++idx]);
+            } else if(arg == "--ticks" && has_value) {
+                max_ticks = static_cast<tick_t>(std::stoul(argv[++idx]));
+            } else if(arg == "--threads" && has_value) {
+                thread_count = static_cast<unsigned>(std::stoul(argv[++idx]));
+            } else if(arg == "--rows" && has_value) {
+                args.rows = std::stoull(argv[++idx]);
+            } else if(arg == "--columns" && has_value) {
+                args.columns = std::stoull(argv[++idx]);
+            } else if(arg == "--nests" && has_value) {
+                args.nest_count = static_cast<nest_id_t>(std::stoul(argv[++idx]));
+            } else if(arg == "--ants" && has_value) {
+                args.ant_count_per_nest = static_cast<ant_id_t>(std::stoul(argv[++idx]));
+            } else if(arg == "--map" && has_value) {
+                map_path = argv[++idx];
+            } else if(arg == "--huge-pages") {
+                args.tile_memory.explicit_huge_pages = true;
+            } else if(arg == "--first-touch-threads" && has_value) {
+                args.tile_memory.first_touch_threads = static_cast<unsigned>(std::stoul(argv[++idx]));
+            } else {
+                values.push_back(std::stof(argv[idx]));
+            }
+        }
+
+        if(values.empty()) throw std::invalid_argument{"no values"};
+    } catch(...) {
+        std::println("Error parsing arguments");
+        return EXIT_FAILURE;
+    }
+
+    try {
+        // The map decides the size of the world and the number of nests, so any given as arguments are replaced
+        if(map_path) {
+            args.map = std::make_shared<const world_map>(*map_path);
+            args.rows = args.map->get_rows();
+            args.columns = args.map->get_columns();
+            args.nest_count = static_cast<nest_id_t>(args.map->get_nests().size());
+        }
+
+        result_cache cache{argv[1]};
+
+        if(cache.get_skipped_lines() != 0) {
+            std::println("Warning: skipped {} unreadable lines in the result cache", cache.get_skipped_lines());
+        }
+
+        std::size_t cached_runs = 0;
+        std::size_t new_runs = 0;
+
+        std::println("Result,parameter,value,seed,cached,ticks,termination,ants,food,births,deaths");
+
+        for(auto value : values) {
+            args.*parameter->member = value;
+
+            // Only the seeds missing from the cache are run, together as an ensemble
+            std::vector<std::uint64_t> missing_seeds;
+
+            for(std::uint64_t seed = 0; seed < seed_count; seed++) {
+                args.seed = seed;
+
+                if(const auto* summary = cache.find(args, max_ticks)) {
+                    print_result(parameter->name, value, seed, true, *summary);
+                    cached_runs++;
+                } else {
+                    missing_seeds.push_back(seed);
+                }
+            }
+
+            if(missing_seeds.empty()) continue;
+
+            ensemble replicas{args, missing_seeds};
+            replicas.run(max_ticks, thread_count, 100);
+
+            for(auto i = 0uz; i < replicas.size(); i++) {
+                args.seed = missing_seeds[i];
+
+                auto summary = summarise(replicas[i]);
+
+                cache.store(args, max_ticks, summary);
+                print_result(parameter->name, value, missing_seeds[i], false, summary);
+                new_runs++;
+            }
+        }
+
+        std::println("Sweep,{},{}", cached_runs, new_runs);
+    } catch(const std::exception& e) {
+        std::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,225 @@
+#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define ANT_SIM_HAS_MMAP
+#endif
+
+namespace ant_sim {
+
+// Arenas are aligned to, and sized in multiples of, the most common huge page size
+// This lets transparent huge pages back the whole arena instead of only its aligned middle
+constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+const char* to_string(page_kind kind) noexcept {
+    switch(kind) {
+    case page_kind::normal:
+        return "normal";
+    case page_kind::transparent_huge:
+        return "transparent_huge";
+    case page_kind::explicit_huge:
+        return "explicit_huge";
+    case page_kind::heap:
+        return "heap";
+    default:
+        std::unreachable();
+    }
+}
+
+static std::size_t round_up(std::size_t value, std::size_t multiple) noexcept {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static std::size_t get_page_size() noexcept {
+#ifdef ANT_SIM_HAS_MMAP
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 4096;
+#endif
+}
+
+#ifdef ANT_SIM_HAS_MMAP
+// Maps size bytes of zeroed memory, returning nullptr on failure
+static std::byte* map_anonymous(std::size_t size, int extra_flags) noexcept {
+    void* pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+
+    return pointer == MAP_FAILED ? nullptr : static_cast<std::byte*>(pointer);
+}
+
+// Maps size bytes of zeroed memory aligned to huge_page_size, returning nullptr on failure
+// size must be a multiple of huge_page_size
+static std::byte* map_aligned(std::size_t size) noexcept {
+    // Over-allocate, then trim the unaligned parts from either end
+    auto padded_size = size + huge_page_size;
+
+    auto* pointer = map_anonymous(padded_size, 0);
+
+    if(!pointer) return nullptr;
+
+    auto address = reinterpret_cast<std::uintptr_t>(pointer);
+
+    auto head = round_up(address, huge_page_size) - address;
+    auto tail = padded_size - head - size;
+
+    if(head != 0) munmap(pointer, head);
+    if(tail != 0) munmap(pointer + head + size, tail);
+
+    return pointer + head;
+}
+#endif
+
+// Writes to every page, splitting the pages into contiguous shares between thread_count threads
+static void touch_pages(std::byte* base, std::size_t size, unsigned thread_count) {
+    auto page_size = get_page_size();
+    auto page_count = (size + page_size - 1) / page_size;
+    auto pages_per_thread = (page_count + thread_count - 1) / thread_count;
+
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count);
+
+    for(auto first_page = 0uz; first_page < page_count; first_page += pages_per_thread) {
+        auto last_page = std::min(first_page + pages_per_thread, page_count);
+
+        threads.emplace_back([=] {
+            for(auto page = first_page; page < last_page; page++) {
+                // Reading would only map the shared zero page, so a write is needed to commit the page
+                *reinterpret_cast<volatile unsigned char*>(base + page * page_size) = 0;
+            }
+        });
+    }
+}
+
+arena::arena(std::size_t size, const arena_options& options) : requested_size{size} {
+    if(size == 0) return;
+
+#ifdef ANT_SIM_HAS_MMAP
+    mapped_size = round_up(size, huge_page_size);
+
+#ifdef MAP_HUGETLB
+    if(options.explicit_huge_pages) {
+        base = map_anonymous(mapped_size, MAP_HUGETLB);
+        kind = page_kind::explicit_huge;
+    }
+#endif
+
+    // Fall back to regular pages if explicit huge pages weren't requested or none were available
+    if(!base) {
+        base = map_aligned(mapped_size);
+
+        if(!base) throw std::bad_alloc{};
+
+        kind = page_kind::normal;
+
+#ifdef MADV_HUGEPAGE
+        if(options.transparent_huge_pages && madvise(base, mapped_size, MADV_HUGEPAGE) == 0) {
+            kind = page_kind::transparent_huge;
+        }
+#endif
+    }
+#else
+    mapped_size = size;
+
+    base = static_cast<std::byte*>(std::calloc(size, 1));
+
+    if(!base) throw std::bad_alloc{};
+
+    kind = page_kind::heap;
+#endif
+
+    if(options.first_touch_threads != 0) {
+        touch_pages(base, mapped_size, options.first_touch_threads);
+    }
+}
+
+void arena::release() noexcept {
+    if(!base) return;
+
+#ifdef ANT_SIM_HAS_MMAP
+    munmap(base, mapped_size);
+#else
+    std::free(base);
+#endif
+
+    base = nullptr;
+}
+
+arena::arena(arena&& other) noexcept
+    : base{std::exchange(other.base, nullptr)}, mapped_size{std::exchange(other.mapped_size, 0)},
+      requested_size{std::exchange(other.requested_size, 0)}, kind{other.kind} {}
+
+arena& arena::operator=(arena&& other) noexcept {
+    if(this != &other) {
+        release();
+
+        base = std::exchange(other.base, nullptr);
+        mapped_size = std::exchange(other.mapped_size, 0);
+        requested_size = std::exchange(other.requested_size, 0);
+        kind = other.kind;
+    }
+
+    return *this;
+}
+
+arena::~arena() { release(); }
+
+arena_stats arena::stats() const {
+    arena_stats result{.size = requested_size, .kind = kind};
+
+    if(!base) return result;
+
+#ifdef __linux__
+    auto page_size = get_page_size();
+
+    // mincore reports which pages are resident, one byte per page
+    std::vector<unsigned char> residency((mapped_size + page_size - 1) / page_size);
+
+    if(mincore(base, mapped_size, residency.data()) == 0) {
+        auto resident_pages = std::ranges::count_if(residency, [](unsigned char page) { return page & 1; });
+
+        result.resident_bytes = static_cast<std::size_t>(resident_pages) * page_size;
+    }
+
+    if(kind == page_kind::explicit_huge) {
+        result.huge_page_bytes = result.resident_bytes;
+        return result;
+    }
+
+    // Huge page usage is only reported per mapping, through /proc/self/smaps
+    // The kernel may merge the arena with neighbouring mappings, so this can include some memory outside the arena
+    auto begin = reinterpret_cast<std::uintptr_t>(base);
+    auto end = begin + mapped_size;
+
+    std::ifstream smaps{"/proc/self/smaps"};
+
+    bool in_arena = false;
+
+    for(std::string line; std::getline(smaps, line);) {
+        auto dash = line.find('-');
+        auto space = line.find(' ');
+
+        // Each mapping starts with a header line of the form "start-end permissions ..."
+        if(dash != std::string::npos && space != std::string::npos && dash < space) {
+            auto mapping_begin = std::stoull(line.substr(0, dash), nullptr, 16);
+            auto mapping_end = std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+
+            in_arena = mapping_begin < end && mapping_end > begin;
+        } else if(in_arena && line.starts_with("AnonHugePages:")) {
+            result.huge_page_bytes += std::stoull(line.substr(line.find(':') + 1)) * 1024;
+        }
+    }
+#endif
+
+    return result;
+}
+
+} // namespace ant_sim
@@ -0,0 +1,112 @@
+#include "delta_stream.hpp"
+
+#include <bit>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace ant_sim {
+
+constexpr std::uint32_t delta_stream_version = 1;
+
+// Appends value to buffer in little endian byte order
+template <typename T>
+static void append(std::vector<std::uint8_t>& buffer, T value) {
+    if constexpr(std::is_same_v<T, float>) {
+        append(buffer, std::bit_cast<std::uint32_t>(value));
+    } else {
+        for(auto i = 0uz; i < sizeof(T); i++) {
+            buffer.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+        }
+    }
+}
+
+delta_writer::delta_writer(const std::filesystem::path& path, const simulation& sim)
+    : file{path, std::ios::binary} {
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not open {} to write a delta stream", path.string())};
+    }
+
+    for(auto c : std::string_view{"ANTDELTA"}) {
+        buffer.push_back(static_cast<std::uint8_t>(c));
+    }
+
+    auto tiles = sim.get_tiles();
+
+    append(buffer, delta_stream_version);
+    append(buffer, static_cast<std::uint64_t>(tiles.extent(0)));
+    append(buffer, static_cast<std::uint64_t>(tiles.extent(1)));
+
+    // Nothing else is placed outside of ticks, so the starting state is found without scanning the world
+    std::vector<point<>> locations;
+
+    for(const auto& nest : sim.get_nests()) {
+        locations.push_back(nest.location);
+    }
+
+    for(auto location : sim.get_food_sources()) {
+        locations.push_back(location);
+    }
+
+    for(const auto& ant : sim.get_ants()) {
+        locations.push_back(ant.location);
+    }
+
+    write_record(sim, locations);
+}
+
+void delta_writer::write_tick(const simulation& sim) {
+    write_record(sim, sim.get_dirty_tiles().get_tiles());
+
+    ticks_written++;
+}
+
+void delta_writer::write_record(const simulation& sim, std::span<const point<>> locations) {
+    auto tiles = sim.get_tiles();
+    auto contents = sim.get_tile_contents();
+    auto epoch = sim.get_pheromone_epoch();
+
+    append(buffer, sim.get_tick_count());
+    append(buffer, static_cast<std::uint32_t>(locations.size()));
+
+    for(auto [x, y] : locations) {
+        const auto& tile = tiles[y, x];
+        const auto& tile_contents = contents[y, x];
+
+        append(buffer, static_cast<std::uint32_t>(x));
+        append(buffer, static_cast<std::uint32_t>(y));
+        // Chunked worlds keep food outside of the tiles, so the flags are read through the simulation
+        auto flags = sim.get_tile_flags({x, y});
+
+        append(buffer, flags);
+
+        // Fields that are meaningless because of the flags are left out, as they may hold anything
+        if(tile.has_nest()) append(buffer, tile.nest_id);
+        if(tile.has_ant()) append(buffer, tile_contents.ant_id);
+        if(flags & tile::has_food_flag) append(buffer, sim.get_food_supply({x, y}));
+
+        const auto& pheromones = tile_contents.pheromones;
+
+        append(buffer, static_cast<std::uint8_t>(pheromones.entry_count()));
+
+        pheromones.for_each_entry([&](const auto& entry) {
+            append(buffer, entry.nest_id);
+
+            for(auto i = 0uz; i < tile::pheromone_type_count; i++) {
+                append(buffer, entry.get_strength(i));
+                append(buffer, entry.get_last_updated(i, epoch));
+            }
+        });
+    }
+
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+    if(!file) throw std::runtime_error{"Error: could not write to the delta stream"};
+
+    bytes_written += buffer.size();
+
+    buffer.clear();
+}
+
+} // namespace ant_sim
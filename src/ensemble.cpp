@@ -0,0 +1,78 @@
+#include "ensemble.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <thread>
+
+namespace ant_sim {
+
+ensemble::ensemble(simulation_args_t args, std::span<const std::uint64_t> seeds) {
+    replicas.reserve(seeds.size());
+
+    args.log_events = false;
+
+    for(auto seed : seeds) {
+        args.seed = seed;
+
+        auto& replica = *replicas.emplace_back(std::make_unique<simulation>(args));
+
+        replica.set_log_ant_state_changes(false);
+    }
+}
+
+void ensemble::run(tick_t max_ticks, unsigned thread_count, tick_t sync_interval,
+                   const std::function<void(tick_t)>& on_sync) {
+    if(replicas.empty()) return;
+
+    auto worker_count = std::clamp<std::size_t>(thread_count, 1, replicas.size());
+    sync_interval = std::max(sync_interval, tick_t{1});
+
+    // Only written by the barrier's completion step, which happens before any worker continues past the barrier
+    tick_t synced_tick = max_ticks;
+
+    for(const auto& replica : replicas) {
+        synced_tick = std::min(synced_tick, replica->get_tick_count());
+    }
+
+    bool finished = false;
+
+    auto on_completion = [&]() noexcept {
+        synced_tick = std::min(synced_tick + sync_interval, max_ticks);
+
+        if(on_sync) on_sync(synced_tick);
+
+        finished = synced_tick >= max_ticks ||
+                   std::ranges::all_of(replicas, [](const auto& replica) { return replica->stopped(); });
+    };
+
+    std::barrier sync_point{static_cast<std::ptrdiff_t>(worker_count), on_completion};
+
+    // Each worker takes every worker_count-th replica, so replicas that end up with more ants are spread out
+    auto work = [&](std::size_t first_replica) {
+        while(!finished) {
+            auto target_tick = std::min(synced_tick + sync_interval, max_ticks);
+
+            for(auto i = first_replica; i < replicas.size(); i += worker_count) {
+                auto& replica = *replicas[i];
+
+                while(replica.get_tick_count() < target_tick && !replica.stopped() && !replica.paused()) {
+                    replica.tick();
+                }
+            }
+
+            sync_point.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(worker_count - 1);
+
+    for(auto i = 1uz; i < worker_count; i++) {
+        workers.emplace_back(work, i);
+    }
+
+    // The calling thread does its share of the work instead of waiting idle
+    work(0);
+}
+
+} // namespace ant_sim
@@ -0,0 +1,204 @@
+#include "frame_exporter.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <format>
+#include <print>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "palette.hpp"
+
+namespace ant_sim {
+
+frame_exporter::frame_exporter(frame_export_options export_options) : options{std::move(export_options)} {
+    options.interval = std::max(options.interval, tick_t{1});
+
+    if(options.thread_count == 0) {
+        options.thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.directory, error);
+
+    if(error) {
+        throw std::runtime_error{std::format("Error: could not create {} to export frames: {}",
+                                             options.directory.string(), error.message())};
+    }
+
+    worker = std::jthread{[this](const std::stop_token& stop_token) { run(stop_token); }};
+}
+
+frame_exporter::~frame_exporter() { finish(); }
+
+void frame_exporter::finish() {
+    if(!worker.joinable()) return;
+
+    worker.request_stop();
+    worker.join();
+}
+
+std::size_t frame_exporter::get_frames_written() {
+    std::scoped_lock lock{mutex};
+    return frames_written;
+}
+
+std::size_t frame_exporter::get_frames_dropped() {
+    std::scoped_lock lock{mutex};
+    return frames_dropped;
+}
+
+void frame_exporter::after_tick(const simulation& sim) {
+    if(sim.get_tick_count() % options.interval != 0) return;
+
+    {
+        std::scoped_lock lock{mutex};
+
+        // The background thread hasn't taken the last frame yet, so it's already a frame behind
+        if(has_queued_frame) {
+            frames_dropped++;
+            return;
+        }
+    }
+
+    // Only the tick thread touches capturing, so the copy doesn't need the lock
+    capture(sim);
+
+    {
+        std::scoped_lock lock{mutex};
+
+        std::swap(capturing, queued);
+        has_queued_frame = true;
+    }
+
+    frame_queued.notify_one();
+}
+
+void frame_exporter::capture(const simulation& sim) {
+    auto tiles = sim.get_tiles();
+    auto contents = sim.get_tile_contents();
+
+    auto rows = tiles.extent(0);
+    auto columns = tiles.extent(1);
+    auto epoch = sim.get_pheromone_epoch();
+
+    capturing.rows = rows;
+    capturing.columns = columns;
+    capturing.tick = sim.get_tick_count();
+    capturing.max_food_supply = sim.max_food_supply;
+    capturing.falloff_rate = sim.falloff_rate;
+
+    // These only allocate for the first few frames, as the snapshots are reused
+    capturing.tiles.resize(rows * columns);
+    capturing.food_supply.resize(rows * columns);
+    capturing.pheromone_strength.resize(rows * columns);
+    capturing.pheromone_last_updated.resize(rows * columns);
+
+    for(auto y = 0uz; y < rows; y++) {
+        for(auto x = 0uz; x < columns; x++) {
+            const auto& tile = tiles[y, x];
+            auto i = y * columns + x;
+
+            capturing.tiles[i] = tile;
+
+            // Nests and ants are drawn without their contents, so those are left stale rather than copied
+            if(tile.has_nest() || tile.has_ant()) continue;
+
+            // Tiles without food are drawn from their pheromones, so their supply of 0 has to be copied too
+            capturing.food_supply[i] = sim.get_food_supply({x, y});
+
+            if(capturing.food_supply[i] == 0) {
+                const auto& pheromones = contents[y, x].pheromones;
+
+                auto nest_id = options.pheromone_nest_id;
+                auto type = options.pheromone_type;
+
+                capturing.pheromone_strength[i] = pheromones.get_strength(nest_id, type);
+                capturing.pheromone_last_updated[i] = pheromones.get_last_updated(nest_id, type, epoch);
+            }
+        }
+    }
+}
+
+void frame_exporter::rasterise() {
+    auto rows = writing.rows;
+    auto columns = writing.columns;
+
+    pixels.resize(rows * columns * 3);
+
+    auto rasterise_rows = [&](std::size_t first_row, std::size_t last_row) {
+        for(auto i = first_row * columns; i < last_row * columns; i++) {
+            // Decaying here rather than while capturing keeps the work off the tick thread
+            auto get_pheromone_strength = [&] {
+                auto ticks_since_last_update = writing.tick - writing.pheromone_last_updated[i];
+
+                return decay_strength(writing.pheromone_strength[i], ticks_since_last_update, writing.falloff_rate);
+            };
+
+            auto [r, g, b] = get_tile_color(writing.tiles[i], writing.food_supply[i], writing.max_food_supply,
+                                            get_pheromone_strength);
+
+            pixels[i * 3] = r;
+            pixels[i * 3 + 1] = g;
+            pixels[i * 3 + 2] = b;
+        }
+    };
+
+    auto band_count = std::clamp<std::size_t>(options.thread_count, 1, std::max(rows, 1uz));
+    auto rows_per_band = (rows + band_count - 1) / band_count;
+
+    // Bands are contiguous, so each thread writes its own part of pixels
+    // This thread rasterises the first band itself, and the other threads are joined as they go out of scope
+    std::vector<std::jthread> threads;
+    threads.reserve(band_count - 1);
+
+    for(auto band = 1uz; band < band_count; band++) {
+        auto first_row = std::min(band * rows_per_band, rows);
+        auto last_row = std::min(first_row + rows_per_band, rows);
+
+        threads.emplace_back(rasterise_rows, first_row, last_row);
+    }
+
+    rasterise_rows(0, std::min(rows_per_band, rows));
+}
+
+void frame_exporter::run(const std::stop_token& stop_token) {
+    while(true) {
+        {
+            std::unique_lock lock{mutex};
+
+            // Once a stop is requested, a frame that's still queued is written before returning
+            frame_queued.wait(lock, stop_token, [&] { return has_queued_frame; });
+
+            if(!has_queued_frame) return;
+
+            std::swap(queued, writing);
+            has_queued_frame = false;
+        }
+
+        rasterise();
+
+        auto file_name = std::format("frame_{:010}.{}", writing.tick, to_string(options.format));
+
+        auto written = true;
+
+        try {
+            write_image(options.directory / file_name, options.format, writing.columns, writing.rows, pixels);
+        } catch(const std::exception& e) {
+            // Failing to write one frame shouldn't stop the simulation, so report it and carry on
+            std::println("{}", e.what());
+            written = false;
+        }
+
+        std::scoped_lock lock{mutex};
+
+        if(written) {
+            frames_written++;
+        } else {
+            frames_dropped++;
+        }
+    }
+}
+
+} // namespace ant_sim
@@ -4,12 +4,13 @@
 
 #include "imgui.h"
 
+#include "palette.hpp"
+
 namespace ant_sim::graphics {
 
 // Returns the top left and bottom right tiles of the visible area
 // This does not account for rotated views
-static std::pair<point<>, point<>>
-get_visible_area(const sf::View& view, stdex::mdspan<tile, stdex::dextents<std::size_t, 2>> tiles, float tile_size) {
+static std::pair<point<>, point<>> get_visible_area(const sf::View& view, const auto& tiles, float tile_size) {
     auto [view_width, view_height] = view.getSize();
     auto [center_x, center_y] = view.getCenter();
 
@@ -32,7 +33,7 @@ get_visible_area(const sf::View& view, stdex::mdspan<tile, stdex::dextents<std::
     return {{left_clamped, top_clamped}, {right_clamped, bottom_clamped}};
 }
 
-void world_drawable::draw_info(simulation& locked_sim) const {
+void world_drawable::draw_info(const simulation& locked_sim) const {
     auto [x, y] = sim->get_mouse_location();
 
     ImGui::Begin("Current tile info");
@@ -55,25 +56,27 @@ void world_drawable::draw_info(simulation& locked_sim) const {
     }
 
     const auto& tile = tiles[tile_y, tile_x];
+    const auto& contents = locked_sim.get_tile_contents()[tile_y, tile_x];
 
     ImGui::Text("%s", std::format("{}, {}", tile_y, tile_x).c_str());
 
-    if(tile.has_nest) {
+    if(tile.has_nest()) {
         auto tile_description =
             std::format("Nest {} with {} food", tile.nest_id, locked_sim.get_nests()[tile.nest_id].food_supply);
         ImGui::Text("%s", tile_description.c_str());
-    } else if(tile.has_ant) {
-        auto& ant = locked_sim.get_ants().at(tile.ant_id);
+    } else if(tile.has_ant()) {
+        const auto& ant = *locked_sim.find_ant(contents.ant_id);
         auto tile_description = std::format("Ant {} from nest {}", ant.ant_id, ant.nest_id);
         ImGui::Text("%s", std::format("{}", tile_description).c_str());
         ImGui::Text("State: %s", ant.state == ant::state::searching ? "Searching" : "Returning");
         ImGui::Text("%s", std::format("Hunger: {}", ant.hunger).c_str());
     }
 
-    if(tile.food_supply > 0) {
-        ImGui::Text("%s", std::format("Food supply: {}", tile.food_supply).c_str());
+    if(auto food_supply = locked_sim.get_food_supply({tile_x, tile_y}); food_supply != 0) {
+        ImGui::Text("%s", std::format("Food supply: {}", food_supply).c_str());
     } else {
-        auto pheromone_strength = tile.pheromones.pheromone_strength[visible_pheromone_nest_id][visible_pheromone_type];
+        auto pheromone_strength =
+            locked_sim.get_pheromone_strength(contents.pheromones, visible_pheromone_nest_id, visible_pheromone_type);
         ImGui::Text("%s", std::format("Pheromones: {:.3f}", pheromone_strength).c_str());
     }
 
@@ -83,7 +86,12 @@ void world_drawable::draw_info(simulation& locked_sim) const {
 void world_drawable::draw(sf::RenderTarget& target, sf::RenderStates states) const {
     auto locked_sim = sim->lock();
 
-    auto tiles = locked_sim->get_tiles();
+    // Drawing only reads the world, so go through a const reference
+    // This also stops a chunked world from allocating chunks just because they were drawn
+    const simulation& world = *locked_sim;
+
+    auto tiles = world.get_tiles();
+    auto contents = world.get_tile_contents();
 
     auto [top_left, bottom_right] = get_visible_area(target.getView(), tiles, tile_size);
 
@@ -91,37 +99,26 @@ void world_drawable::draw(sf::RenderTarget& target, sf::RenderStates states) con
 
     for(auto y = top_left.y; y < bottom_right.y; y++) {
         for(auto x = top_left.x; x < bottom_right.x; x++) {
-            auto& tile = tiles[y, x];
-
-            sf::Color color{};
-
-            // Make sure pheromone values are up to date before drawing
-            for(nest_id_t i = 0uz; i < tile::pheromone_type_count; i++) {
-                locked_sim->update_pheromones(tile.pheromones, sim->get_tick_count(), i);
-            }
+            const auto& tile = tiles[y, x];
 
-            if(tile.has_nest) {
-                color = {0, 0, 255};
-            } else if(tile.has_ant) {
-                color = {255, 255, 255};
-            } else if(tile.food_supply > 0) {
-                color = {0, static_cast<std::uint8_t>(255 * tile.food_supply / locked_sim->max_food_supply), 0};
-            } else {
-                auto red = tile.pheromones.pheromone_strength[visible_pheromone_nest_id][visible_pheromone_type];
+            // Only tiles with pheromones need their contents to be loaded
+            auto get_pheromone_strength = [&] {
+                return world.get_pheromone_strength(contents[y, x].pheromones, visible_pheromone_nest_id,
+                                                    visible_pheromone_type);
+            };
 
-                red = static_cast<pheromone_strength_t>(std::clamp(static_cast<float>(red) * 30.0f, 0.0f, 255.0f));
+            auto food_supply = world.get_food_supply({x, y});
 
-                color = {static_cast<std::uint8_t>(red), 0, 0};
-            }
+            auto [r, g, b] = get_tile_color(tile, food_supply, world.max_food_supply, get_pheromone_strength);
 
             rectangle.setPosition({static_cast<float>(x) * tile_size, static_cast<float>(y) * tile_size});
-            rectangle.setFillColor(color);
+            rectangle.setFillColor({r, g, b});
 
             target.draw(rectangle, states);
         }
     }
 
-    draw_info(*locked_sim);
+    draw_info(world);
 }
 
 void world_drawable::zoom_view(sf::View& view, bool zoom_in) noexcept {
@@ -2,12 +2,15 @@
 
 #include <stdexcept>
 #include <format>
+#include <cfloat>
 
 #include <imgui.h>
 #include <imgui-SFML.h>
 
 namespace ant_sim::gui {
 
+constexpr auto memory_refresh_interval = sf::seconds(1);
+
 gui::gui(sf::RenderWindow& window, simulation_mutex& sim, graphics::world_drawable& world_drawable)
     : window{&window}, sim{&sim}, world_drawable{&world_drawable} {
     if(imgui_initialized) {
@@ -25,6 +28,42 @@ void gui::process_event(const sf::Event& event) const {
     ImGui::SFML::ProcessEvent(*window, event);
 }
 
+// Plots one series of the history, with its latest value overlaid
+static void plot_series(const char* label, const stats_history::snapshot& history, std::size_t series) {
+    auto* samples = history.get_series(series);
+    auto count = static_cast<int>(history.count);
+
+    auto latest = std::format("{:.2f}", count == 0 ? 0.0f : samples[count - 1]);
+
+    ImGui::PlotLines(label, samples, count, 0, latest.c_str(), FLT_MAX, FLT_MAX, ImVec2{0, 60});
+}
+
+void gui::draw_history() const {
+    // Read without locking, so that plotting never holds up the simulation thread
+    sim->get_stats_history().read(history);
+
+    ImGui::Begin("Simulation history");
+
+    ImGui::Text("%s", std::format("Each point is the mean of {} ticks", history.stride).c_str());
+
+    plot_series("Ants", history, stats_history::ant_count);
+    plot_series("Food", history, stats_history::food_count);
+    plot_series("Births per tick", history, stats_history::births);
+    plot_series("Deaths per tick", history, stats_history::deaths);
+    plot_series("Tick time (ms)", history, stats_history::tick_time_ms);
+
+    auto nest_count = (sim->get_stats_history().get_series_count() - stats_history::fixed_series_count) / 2;
+
+    for(auto nest_id = 0uz; nest_id < nest_count; nest_id++) {
+        if(!ImGui::CollapsingHeader(std::format("Nest {}", nest_id).c_str())) continue;
+
+        plot_series(std::format("Population##{}", nest_id).c_str(), history, stats_history::nest_population(nest_id));
+        plot_series(std::format("Food##{}", nest_id).c_str(), history, stats_history::nest_food(nest_id));
+    }
+
+    ImGui::End();
+}
+
 void gui::draw_gui(sf::Time delta_time) const {
     // Begin a new ImGui frame
     ImGui::SFML::Update(*window, delta_time);
@@ -39,10 +78,13 @@ void gui::draw_gui(sf::Time delta_time) const {
 
     auto locked_sim = sim->lock();
 
-    // Get speed in updates per second, then allow setting it with a slider
-    float speed = 1 / std::chrono::duration<float>{locked_sim->sleep_time}.count();
-    ImGui::SliderFloat("Updates per second", &speed, 0.5f, 100);
-    locked_sim->sleep_time = std::chrono::duration<float>{1 / speed};
+    ImGui::SliderFloat("Updates per second", &locked_sim->target_tick_rate, 0.5f, 10000, "%.1f",
+                       ImGuiSliderFlags_Logarithmic);
+    ImGui::Checkbox("As fast as possible", &locked_sim->run_unlimited);
+
+    int ticks_per_step = static_cast<int>(locked_sim->ticks_per_step);
+    ImGui::SliderInt("Ticks per step", &ticks_per_step, 1, 1000, "%d", ImGuiSliderFlags_Logarithmic);
+    locked_sim->ticks_per_step = static_cast<tick_t>(ticks_per_step);
 
     auto nest_count = static_cast<nest_id_t>(locked_sim->get_nests().size());
 
@@ -64,9 +106,45 @@ void gui::draw_gui(sf::Time delta_time) const {
 
     ImGui::Begin("Simulation stats");
     ImGui::Text("%s", std::format("Tick: {}", sim->get_tick_count()).c_str());
+    if(locked_sim->run_unlimited) {
+        ImGui::Text("%s", std::format("Ticks per second: {:.1f} (unlimited)", sim->get_achieved_tick_rate()).c_str());
+    } else {
+        auto tick_rate_description = std::format("Ticks per second: {:.1f} of {:.1f}", sim->get_achieved_tick_rate(),
+                                                 locked_sim->target_tick_rate);
+        ImGui::Text("%s", tick_rate_description.c_str());
+    }
     ImGui::Text("%s", std::format("Ant count: {}", locked_sim->get_ants().size()).c_str());
     ImGui::Text("%s", std::format("Total food count: {}", locked_sim->get_food_count()).c_str());
+
+    auto nest_stats = locked_sim->get_nest_stats();
+
+    for(auto nest_id = 0uz; nest_id < nest_stats.size(); nest_id++) {
+        const auto& stats = nest_stats[nest_id];
+
+        auto nest_description = std::format("Nest {}: {} ants, {} births, {} deaths, {:.0f} food gathered", nest_id,
+                                            stats.population, stats.births, stats.deaths, stats.food_gathered);
+        ImGui::Text("%s", nest_description.c_str());
+    }
+
+    if(!memory_measured || memory_clock.getElapsedTime() >= memory_refresh_interval) {
+        memory = locked_sim->get_memory_usage();
+        memory_clock.restart();
+        memory_measured = true;
+    }
+
+    constexpr double bytes_per_mib = 1 << 20;
+
+    auto memory_mib = static_cast<double>(memory.total()) / bytes_per_mib;
+    auto estimated_mib = static_cast<double>(locked_sim->get_estimated_memory_usage().total()) / bytes_per_mib;
+
+    auto memory_description = std::format("Memory: {:.1f} MiB, estimated peak {:.1f} MiB", memory_mib, estimated_mib);
+    ImGui::Text("%s", memory_description.c_str());
+
     ImGui::End();
+
+    locked_sim.unlock();
+
+    draw_history();
 }
 
 void gui::render() const { ImGui::SFML::Render(*window); }
@@ -0,0 +1,229 @@
+#include "image_writer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ant_sim {
+
+const char* to_string(image_format format) noexcept {
+    switch(format) {
+    case image_format::ppm:
+        return "ppm";
+    case image_format::png:
+        return "png";
+    default:
+        std::unreachable();
+    }
+}
+
+// The largest payload of a stored deflate block
+constexpr std::size_t max_stored_block_size = 65535;
+
+// PNG chunks are written in pieces no larger than this, well below the format's 2^31 - 1 limit
+constexpr std::size_t max_chunk_size = 1 << 30;
+
+constexpr auto crc_table = [] {
+    std::array<std::uint32_t, 256> table{};
+
+    for(std::uint32_t i = 0; i < 256; i++) {
+        auto crc = i;
+
+        for(auto bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? 0xedb88320u ^ (crc >> 1) : crc >> 1;
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}();
+
+// Running checksums over the bytes written so far, as required by PNG chunks and zlib streams
+struct checksums {
+    std::uint32_t crc = 0xffffffffu;
+    std::uint32_t adler_a = 1;
+    std::uint32_t adler_b = 0;
+
+    void update_crc(std::span<const std::uint8_t> bytes) noexcept {
+        for(auto byte : bytes) {
+            crc = crc_table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+        }
+    }
+
+    void update_adler(std::span<const std::uint8_t> bytes) noexcept {
+        // Deferring the modulo as long as the sums can't overflow is much faster than taking it every byte
+        constexpr std::size_t max_run = 5552;
+        constexpr std::uint32_t modulus = 65521;
+
+        while(!bytes.empty()) {
+            auto run = bytes.first(std::min(bytes.size(), max_run));
+
+            for(auto byte : run) {
+                adler_a += byte;
+                adler_b += adler_a;
+            }
+
+            adler_a %= modulus;
+            adler_b %= modulus;
+
+            bytes = bytes.subspan(run.size());
+        }
+    }
+
+    [[nodiscard]] std::uint32_t get_crc() const noexcept { return crc ^ 0xffffffffu; }
+    [[nodiscard]] std::uint32_t get_adler() const noexcept { return adler_b << 16 | adler_a; }
+};
+
+static std::array<std::uint8_t, 4> big_endian(std::uint32_t value) noexcept {
+    return {static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+            static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value)};
+}
+
+static void write_bytes(std::ofstream& file, std::span<const std::uint8_t> bytes) {
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+static void write_chunk(std::ofstream& file, std::string_view type, std::span<const std::uint8_t> data) {
+    checksums sums;
+
+    auto type_bytes = std::span{reinterpret_cast<const std::uint8_t*>(type.data()), type.size()};
+
+    sums.update_crc(type_bytes);
+    sums.update_crc(data);
+
+    write_bytes(file, big_endian(static_cast<std::uint32_t>(data.size())));
+    write_bytes(file, type_bytes);
+    write_bytes(file, data);
+    write_bytes(file, big_endian(sums.get_crc()));
+}
+
+static void write_ppm(std::ofstream& file, std::size_t width, std::size_t height,
+                      std::span<const std::uint8_t> pixels) {
+    auto header = std::format("P6\n{} {}\n255\n", width, height);
+
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    write_bytes(file, pixels);
+}
+
+// Builds the zlib stream for the image's scanlines, each preceded by a filter type of none
+static std::vector<std::uint8_t> build_zlib_stream(std::size_t width, std::size_t height,
+                                                   std::span<const std::uint8_t> pixels) {
+    auto row_bytes = width * 3;
+    auto raw_size = (row_bytes + 1) * height;
+    auto block_count = std::max((raw_size + max_stored_block_size - 1) / max_stored_block_size, 1uz);
+
+    std::vector<std::uint8_t> stream;
+    stream.reserve(2 + raw_size + block_count * 5 + 4);
+
+    // Deflate with a 32 KiB window and no preset dictionary, with check bits making the header a multiple of 31
+    stream.push_back(0x78);
+    stream.push_back(0x01);
+
+    checksums sums;
+
+    auto block_remaining = 0uz;
+    auto raw_remaining = raw_size;
+
+    // Starts a stored block whenever the previous one is full
+    auto append = [&](std::span<const std::uint8_t> bytes) {
+        while(!bytes.empty()) {
+            if(block_remaining == 0) {
+                block_remaining = std::min(raw_remaining, max_stored_block_size);
+                raw_remaining -= block_remaining;
+
+                auto length = static_cast<std::uint16_t>(block_remaining);
+                auto inverted_length = static_cast<std::uint16_t>(~length);
+                auto is_final = raw_remaining == 0;
+
+                stream.push_back(is_final ? 1 : 0);
+                stream.push_back(static_cast<std::uint8_t>(length));
+                stream.push_back(static_cast<std::uint8_t>(length >> 8));
+                stream.push_back(static_cast<std::uint8_t>(inverted_length));
+                stream.push_back(static_cast<std::uint8_t>(inverted_length >> 8));
+            }
+
+            auto piece = bytes.first(std::min(bytes.size(), block_remaining));
+
+            stream.insert(stream.end(), piece.begin(), piece.end());
+            sums.update_adler(piece);
+
+            block_remaining -= piece.size();
+            bytes = bytes.subspan(piece.size());
+        }
+    };
+
+    constexpr std::uint8_t filter_none[] = {0};
+
+    for(auto y = 0uz; y < height; y++) {
+        append(filter_none);
+        append(pixels.subspan(y * row_bytes, row_bytes));
+    }
+
+    auto adler = big_endian(sums.get_adler());
+    stream.insert(stream.end(), adler.begin(), adler.end());
+
+    return stream;
+}
+
+static void write_png(std::ofstream& file, std::size_t width, std::size_t height,
+                      std::span<const std::uint8_t> pixels) {
+    constexpr std::uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    write_bytes(file, signature);
+
+    auto width_bytes = big_endian(static_cast<std::uint32_t>(width));
+    auto height_bytes = big_endian(static_cast<std::uint32_t>(height));
+
+    // 8 bits per channel, truecolour, deflate, adaptive filtering, no interlacing
+    // clang-format off
+    const std::uint8_t header[] = {
+        width_bytes[0], width_bytes[1], width_bytes[2], width_bytes[3],
+        height_bytes[0], height_bytes[1], height_bytes[2], height_bytes[3],
+        8, 2, 0, 0, 0
+    };
+    // clang-format on
+
+    write_chunk(file, "IHDR", header);
+
+    auto stream = build_zlib_stream(width, height, pixels);
+
+    for(auto data = std::span<const std::uint8_t>{stream}; !data.empty();) {
+        auto piece = data.first(std::min(data.size(), max_chunk_size));
+
+        write_chunk(file, "IDAT", piece);
+
+        data = data.subspan(piece.size());
+    }
+
+    write_chunk(file, "IEND", {});
+}
+
+void write_image(const std::filesystem::path& path, image_format format, std::size_t width, std::size_t height,
+                 std::span<const std::uint8_t> pixels) {
+    std::ofstream file{path, std::ios::binary};
+
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not open {} to write an image", path.string())};
+    }
+
+    if(format == image_format::ppm) {
+        write_ppm(file, width, height, pixels);
+    } else {
+        write_png(file, width, height, pixels);
+    }
+
+    file.flush();
+
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not write the image {}", path.string())};
+    }
+}
+
+} // namespace ant_sim
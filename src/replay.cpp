@@ -0,0 +1,262 @@
+#include "replay.hpp"
+
+#include <charconv>
+#include <format>
+#include <memory>
+#include <print>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ant_sim {
+
+constexpr int journal_version = 1;
+
+static const char* to_string(simulation::simulation_state state) noexcept {
+    switch(state) {
+    case simulation::simulation_state::running:
+        return "running";
+    case simulation::simulation_state::stopped:
+        return "stopped";
+    case simulation::simulation_state::single_step:
+        return "single_step";
+    case simulation::simulation_state::paused:
+        return "paused";
+    default:
+        std::unreachable();
+    }
+}
+
+replay_recorder::replay_recorder(const std::filesystem::path& path, const simulation& sim,
+                                 const simulation_args_t& args)
+    : file{path}, recorded_state{sim.get_state()} {
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not open {} to record a replay", path.string())};
+    }
+
+    for(auto i = 0uz; i < std::size(tunable_parameters); i++) {
+        recorded_parameters[i] = sim.*tunable_parameters[i].member;
+    }
+
+    std::println(file, "Journal,{}", journal_version);
+    std::println(file, "Seed,{}", sim.get_seed());
+    std::println(file, "Args,{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}", args.rows, args.columns, args.nest_count,
+                 args.ant_count_per_nest, args.hunger_increase_per_tick, args.hunger_to_die, args.food_taken,
+                 args.food_resupply_rate, args.max_food_supply, args.food_per_new_ant, args.food_hunger_ratio,
+                 args.falloff_rate, args.increase_rate, args.type1_avoidance, args.type2_avoidance);
+
+    if(args.map) std::println(file, "Map,{:016x},{}", args.map->get_checksum(), args.map->get_path().string());
+
+    // The order ants are ticked in changes how a run plays out, so a different sort interval has to be replayed
+    if(args.ant_sort_interval != simulation_args_t{}.ant_sort_interval) {
+        std::println(file, "Sort,{}", args.ant_sort_interval);
+    }
+
+    // The parameters may already differ from args if they were changed before recording started
+    for(auto i = 0uz; i < std::size(tunable_parameters); i++) {
+        auto name = tunable_parameters[i].name;
+
+        std::println(file, "Param,{},{},{}", sim.get_tick_count(), name, recorded_parameters[i]);
+    }
+
+    file.flush();
+}
+
+void replay_recorder::record_changes(const simulation& sim) {
+    auto tick = sim.get_tick_count();
+    auto changed = false;
+
+    for(auto i = 0uz; i < std::size(tunable_parameters); i++) {
+        auto value = sim.*tunable_parameters[i].member;
+
+        if(value == recorded_parameters[i]) continue;
+
+        std::println(file, "Param,{},{},{}", tick, tunable_parameters[i].name, value);
+
+        recorded_parameters[i] = value;
+        changed = true;
+    }
+
+    if(auto state = sim.get_state(); state != recorded_state) {
+        std::println(file, "State,{},{}", tick, to_string(state));
+
+        recorded_state = state;
+        changed = true;
+    }
+
+    // Flush right away, so that the journal is still usable if the program crashes
+    if(changed) file.flush();
+}
+
+void replay_recorder::record_end(const simulation& sim) {
+    record_changes(sim);
+
+    std::println(file, "End,{}", sim.get_tick_count());
+    file.flush();
+}
+
+// Splits a line into its comma separated fields
+static std::vector<std::string_view> split_fields(std::string_view line) {
+    std::vector<std::string_view> fields;
+
+    for(auto comma = line.find(','); comma != std::string_view::npos; comma = line.find(',')) {
+        fields.push_back(line.substr(0, comma));
+        line.remove_prefix(comma + 1);
+    }
+
+    fields.push_back(line);
+
+    return fields;
+}
+
+template <typename T>
+static T parse_field(std::string_view field) {
+    T value{};
+
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+
+    if(error != std::errc{} || end != field.data() + field.size()) {
+        throw std::runtime_error{std::format("Error: invalid value '{}' in replay journal", field)};
+    }
+
+    return value;
+}
+
+static std::size_t find_parameter(std::string_view name) {
+    for(auto i = 0uz; i < std::size(tunable_parameters); i++) {
+        if(name == tunable_parameters[i].name) return i;
+    }
+
+    throw std::runtime_error{std::format("Error: unknown parameter '{}' in replay journal", name)};
+}
+
+replay_journal read_journal(const std::filesystem::path& path) {
+    std::ifstream file{path};
+
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not open replay journal {}", path.string())};
+    }
+
+    replay_journal journal;
+
+    bool has_version = false;
+    bool has_seed = false;
+    bool has_args = false;
+
+    for(std::string line; std::getline(file, line);) {
+        if(line.empty()) continue;
+
+        auto fields = split_fields(line);
+        auto record = fields[0];
+
+        auto expect_fields = [&](std::size_t count) {
+            if(fields.size() != count) {
+                throw std::runtime_error{std::format("Error: malformed {} record in replay journal", record)};
+            }
+        };
+
+        if(record == "Journal") {
+            expect_fields(2);
+
+            if(parse_field<int>(fields[1]) != journal_version) {
+                throw std::runtime_error{std::format("Error: unsupported replay journal version {}", fields[1])};
+            }
+
+            has_version = true;
+        } else if(record == "Seed") {
+            expect_fields(2);
+
+            journal.args.seed = parse_field<std::uint64_t>(fields[1]);
+            has_seed = true;
+        } else if(record == "Args") {
+            expect_fields(16);
+
+            auto& args = journal.args;
+
+            args.rows = parse_field<std::size_t>(fields[1]);
+            args.columns = parse_field<std::size_t>(fields[2]);
+            args.nest_count = parse_field<nest_id_t>(fields[3]);
+            args.ant_count_per_nest = parse_field<ant_id_t>(fields[4]);
+            args.hunger_increase_per_tick = parse_field<float>(fields[5]);
+            args.hunger_to_die = parse_field<float>(fields[6]);
+            args.food_taken = parse_field<food_supply_t>(fields[7]);
+            args.food_resupply_rate = parse_field<food_supply_t>(fields[8]);
+            args.max_food_supply = parse_field<food_supply_t>(fields[9]);
+            args.food_per_new_ant = parse_field<food_supply_t>(fields[10]);
+            args.food_hunger_ratio = parse_field<float>(fields[11]);
+            args.falloff_rate = parse_field<float>(fields[12]);
+            args.increase_rate = parse_field<pheromone_strength_t>(fields[13]);
+            args.type1_avoidance = parse_field<float>(fields[14]);
+            args.type2_avoidance = parse_field<float>(fields[15]);
+
+            has_args = true;
+        } else if(record == "Map") {
+            if(fields.size() < 3) throw std::runtime_error{"Error: malformed Map record in replay journal"};
+
+            std::uint64_t checksum = 0;
+            auto checksum_field = fields[1];
+
+            if(std::from_chars(checksum_field.data(), checksum_field.data() + checksum_field.size(), checksum, 16).ec !=
+               std::errc{}) {
+                throw std::runtime_error{std::format("Error: invalid value '{}' in replay journal", checksum_field)};
+            }
+
+            // The path may contain commas, so it is everything after the checksum
+            auto map_path = std::string_view{line}.substr(fields[0].size() + fields[1].size() + 2);
+
+            auto map = std::make_shared<const world_map>(std::filesystem::path{map_path});
+
+            // A map edited since the run was recorded would play out differently
+            if(map->get_checksum() != checksum) {
+                throw std::runtime_error{std::format("Error: world map {} has changed since the replay was recorded",
+                                                     map_path)};
+            }
+
+            journal.args.map = std::move(map);
+        } else if(record == "Sort") {
+            expect_fields(2);
+
+            journal.args.ant_sort_interval = parse_field<tick_t>(fields[1]);
+        } else if(record == "Param") {
+            expect_fields(4);
+
+            // clang-format off
+            journal.changes.push_back({
+                .tick = parse_field<tick_t>(fields[1]),
+                .parameter = find_parameter(fields[2]),
+                .value = parse_field<float>(fields[3])
+            });
+            // clang-format on
+        } else if(record == "State") {
+            expect_fields(3);
+        } else if(record == "End") {
+            expect_fields(2);
+
+            journal.end_tick = parse_field<tick_t>(fields[1]);
+        } else {
+            throw std::runtime_error{std::format("Error: unknown record '{}' in replay journal", record)};
+        }
+    }
+
+    if(!has_version || !has_seed || !has_args) {
+        throw std::runtime_error{std::format("Error: {} is missing its header", path.string())};
+    }
+
+    return journal;
+}
+
+void replay(simulation& sim, const replay_journal& journal, tick_t end_tick) {
+    auto next_change = journal.changes.begin();
+
+    while(sim.get_tick_count() < end_tick && !sim.stopped()) {
+        // Changes were recorded before the tick they first applied to
+        for(; next_change != journal.changes.end() && next_change->tick <= sim.get_tick_count(); ++next_change) {
+            sim.*tunable_parameters[next_change->parameter].member = next_change->value;
+        }
+
+        sim.tick();
+    }
+}
+
+} // namespace ant_sim
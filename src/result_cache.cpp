@@ -0,0 +1,207 @@
+#include "result_cache.hpp"
+
+#include "state_hash.hpp"
+
+#include <ant_sim_project/version.hpp>
+
+#include <charconv>
+#include <format>
+#include <print>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ant_sim {
+
+run_summary summarise(const simulation& sim) {
+    auto nests = sim.get_nest_stats();
+
+    // clang-format off
+    return {
+        .ticks = sim.get_tick_count(),
+        .termination = sim.get_termination_reason(),
+        .ant_count = sim.get_ants().size(),
+        .food_count = sim.get_food_count(),
+        .births = sim.get_births(),
+        .deaths = sim.get_deaths(),
+        .state_hash = hash_state(sim),
+        .nests = {nests.begin(), nests.end()}
+    };
+    // clang-format on
+}
+
+std::string describe_run(const simulation_args_t& args, tick_t max_ticks) {
+    if(!args.seed) throw std::runtime_error{"Error: only runs with a fixed seed can be cached"};
+
+    const auto& termination = args.termination;
+
+    // Floats are written with enough digits to be read back exactly, so different values never look the same
+    auto description = std::format("v{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{};{}",
+                       ant_sim_project::SIMULATION_VERSION, *args.seed, max_ticks, simulation::default_food_chance,
+                       args.rows, args.columns, args.nest_count, args.ant_count_per_nest,
+                       args.hunger_increase_per_tick, args.hunger_to_die, args.food_taken, args.food_resupply_rate,
+                       args.max_food_supply, args.food_per_new_ant, args.food_hunger_ratio, args.falloff_rate,
+                       args.increase_rate, args.type1_avoidance, args.type2_avoidance, termination.stop_on_collapse,
+                       termination.steady_state_window, termination.steady_state_tolerance);
+
+    // Maps are identified by their contents rather than their path, and generated worlds keep their old descriptions
+    if(args.map) description += std::format(";map={:016x}", args.map->get_checksum());
+
+    if(args.ant_sort_interval != simulation_args_t{}.ant_sort_interval) {
+        description += std::format(";sort={}", args.ant_sort_interval);
+    }
+
+    // Compact pheromones round strengths, which changes where ants move, so their results can't be shared with full
+    // precision builds. Validating builds run with compact pheromones too, so they share results with compact builds
+#ifdef ANT_SIM_COMPACT_PHEROMONES
+    description += ";compact";
+#endif
+
+    return description;
+}
+
+std::uint64_t make_run_key(const simulation_args_t& args, tick_t max_ticks) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+
+    for(auto c : describe_run(args, max_ticks)) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 0x100000001b3;
+    }
+
+    return hash;
+}
+
+// Splits a line into its comma separated fields
+static std::vector<std::string_view> split_fields(std::string_view line) {
+    std::vector<std::string_view> fields;
+
+    for(auto comma = line.find(','); comma != std::string_view::npos; comma = line.find(',')) {
+        fields.push_back(line.substr(0, comma));
+        line.remove_prefix(comma + 1);
+    }
+
+    fields.push_back(line);
+
+    return fields;
+}
+
+// Returns false instead of throwing, as unreadable lines are skipped
+template <typename T>
+static bool try_parse(std::string_view field, T& value, int base = 10) {
+    std::from_chars_result result;
+
+    if constexpr(std::is_floating_point_v<T>) {
+        result = std::from_chars(field.data(), field.data() + field.size(), value);
+    } else {
+        result = std::from_chars(field.data(), field.data() + field.size(), value, base);
+    }
+
+    return result.ec == std::errc{} && result.ptr == field.data() + field.size();
+}
+
+static bool try_parse(std::string_view field, termination_reason& value) {
+    for(auto reason : {termination_reason::none, termination_reason::collapse, termination_reason::steady_state}) {
+        if(field == to_string(reason)) {
+            value = reason;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The fields before the nests, and the fields of each nest
+constexpr std::size_t fixed_field_count = 11;
+constexpr std::size_t nest_field_count = 4;
+
+result_cache::result_cache(const std::filesystem::path& path) {
+    auto ends_with_newline = true;
+
+    if(std::ifstream existing{path}; existing) {
+        for(std::string line; std::getline(existing, line);) {
+            if(line.empty()) continue;
+
+            // Records always end with a newline, so a last line without one was cut off while being written
+            if(existing.eof()) {
+                ends_with_newline = false;
+                skipped_lines++;
+                continue;
+            }
+
+            auto fields = split_fields(line);
+
+            std::uint64_t key = 0;
+            entry result;
+            auto& summary = result.summary;
+            std::size_t nest_count = 0;
+
+            auto valid = fields.size() >= fixed_field_count && fields[0] == "Result" &&
+                         try_parse(fields[1], key, 16) && try_parse(fields[3], summary.ticks) &&
+                         try_parse(fields[4], summary.termination) && try_parse(fields[5], summary.ant_count) &&
+                         try_parse(fields[6], summary.food_count) && try_parse(fields[7], summary.births) &&
+                         try_parse(fields[8], summary.deaths) && try_parse(fields[9], summary.state_hash, 16) &&
+                         try_parse(fields[10], nest_count) &&
+                         fields.size() == fixed_field_count + nest_count * nest_field_count;
+
+            for(auto i = 0uz; valid && i < nest_count; i++) {
+                auto nest_fields = std::span{fields}.subspan(fixed_field_count + i * nest_field_count);
+                auto& nest = summary.nests.emplace_back();
+
+                valid = try_parse(nest_fields[0], nest.population) && try_parse(nest_fields[1], nest.births) &&
+                        try_parse(nest_fields[2], nest.deaths) && try_parse(nest_fields[3], nest.food_gathered);
+            }
+
+            if(!valid) {
+                skipped_lines++;
+                continue;
+            }
+
+            result.description = fields[2];
+
+            // Later records replace earlier ones
+            results.insert_or_assign(key, std::move(result));
+        }
+    }
+
+    file.open(path, std::ios::app);
+
+    if(!file) {
+        throw std::runtime_error{std::format("Error: could not open result cache {}", path.string())};
+    }
+
+    // Finish a line cut off by a crash, so that the next record starts on a line of its own
+    if(!ends_with_newline) std::println(file, "");
+}
+
+const run_summary* result_cache::find(const simulation_args_t& args, tick_t max_ticks) const {
+    auto it = results.find(make_run_key(args, max_ticks));
+
+    if(it == results.end() || it->second.description != describe_run(args, max_ticks)) return nullptr;
+
+    return &it->second.summary;
+}
+
+void result_cache::store(const simulation_args_t& args, tick_t max_ticks, const run_summary& summary) {
+    auto key = make_run_key(args, max_ticks);
+    auto description = describe_run(args, max_ticks);
+
+    std::print(file, "Result,{:016x},{},{},{},{},{},{},{},{:016x},{}", key, description, summary.ticks,
+               to_string(summary.termination), summary.ant_count, summary.food_count, summary.births,
+               summary.deaths, summary.state_hash, summary.nests.size());
+
+    for(const auto& nest : summary.nests) {
+        std::print(file, ",{},{},{},{}", nest.population, nest.births, nest.deaths, nest.food_gathered);
+    }
+
+    std::println(file, "");
+
+    // Flush right away, so that the result survives if the program crashes
+    file.flush();
+
+    if(!file) throw std::runtime_error{"Error: could not write to the result cache"};
+
+    results.insert_or_assign(key, entry{std::move(description), summary});
+}
+
+} // namespace ant_sim
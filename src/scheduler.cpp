@@ -0,0 +1,95 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace ant_sim {
+
+using scheduler_clock = std::chrono::steady_clock;
+
+// How often the achieved tick rate is recalculated
+constexpr auto tick_rate_window = std::chrono::milliseconds{500};
+
+// How long to wait before checking again while the simulation is paused
+constexpr auto paused_poll_interval = std::chrono::milliseconds{10};
+
+// If the simulation falls further behind than this, the missed ticks are dropped instead of being run as a burst
+constexpr auto max_lag = std::chrono::milliseconds{250};
+
+void run_simulation(const std::stop_token& stop_token, simulation_mutex& sim, tick_t max_ticks,
+                    replay_recorder* recorder, frame_exporter* exporter, delta_writer* deltas,
+                    snapshot_publisher* snapshots) {
+    auto next_deadline = scheduler_clock::now();
+
+    auto window_start = next_deadline;
+    tick_t window_ticks = 0;
+
+    while(!sim.stopped() && !stop_token.stop_requested()) {
+        auto locked_sim = sim.lock();
+
+        auto run_unlimited = locked_sim->run_unlimited;
+        auto batch_size = std::max(locked_sim->ticks_per_step, tick_t{1});
+        auto period = std::chrono::duration<float>{1 / locked_sim->target_tick_rate};
+
+        // The GUI can only change parameters while it holds the lock, so they can't change during the batch
+        if(recorder) recorder->record_changes(*locked_sim);
+
+        tick_t ticks_run = 0;
+
+        // The termination policy may stop the simulation partway through a batch
+        while(ticks_run < batch_size && !locked_sim->paused() && !locked_sim->stopped()) {
+            if(locked_sim->get_tick_count() > max_ticks) {
+                sim.stop();
+                break;
+            }
+
+            locked_sim->tick();
+            ticks_run++;
+
+            if(exporter) exporter->after_tick(*locked_sim);
+            if(deltas) deltas->write_tick(*locked_sim);
+            if(snapshots) snapshots->after_tick(*locked_sim);
+        }
+
+        locked_sim.unlock();
+
+        auto now = scheduler_clock::now();
+
+        window_ticks += ticks_run;
+
+        if(now - window_start >= tick_rate_window) {
+            auto elapsed = std::chrono::duration<float>{now - window_start};
+
+            sim.set_achieved_tick_rate(static_cast<float>(window_ticks) / elapsed.count());
+
+            window_start = now;
+            window_ticks = 0;
+        }
+
+        if(ticks_run == 0) {
+            // Nothing ran, so there is no schedule to keep up with
+            next_deadline = now + paused_poll_interval;
+        } else if(run_unlimited) {
+            next_deadline = now;
+
+            // Give the render thread a chance to take the lock
+            std::this_thread::yield();
+            continue;
+        } else {
+            auto batch_period = period * static_cast<float>(ticks_run);
+
+            next_deadline += std::chrono::duration_cast<scheduler_clock::duration>(batch_period);
+
+            if(now - next_deadline > max_lag) {
+                next_deadline = now;
+            }
+        }
+
+        std::this_thread::sleep_until(next_deadline);
+    }
+
+    if(recorder) recorder->record_end(*sim.lock());
+}
+
+} // namespace ant_sim
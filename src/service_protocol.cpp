@@ -0,0 +1,176 @@
+#include "service_protocol.hpp"
+
+#include "state_hash.hpp"
+
+#include <bit>
+#include <charconv>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace ant_sim {
+
+static std::vector<std::string_view> split(std::string_view text, char separator) {
+    std::vector<std::string_view> parts;
+
+    for(auto found = text.find(separator); found != std::string_view::npos; found = text.find(separator)) {
+        parts.push_back(text.substr(0, found));
+        text.remove_prefix(found + 1);
+    }
+
+    parts.push_back(text);
+
+    return parts;
+}
+
+template <typename T>
+static T parse_field(std::string_view field) {
+    T value{};
+
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+
+    if(error != std::errc{} || end != field.data() + field.size()) {
+        throw std::runtime_error{std::format("Error: invalid value '{}' in request", field)};
+    }
+
+    return value;
+}
+
+static std::uint8_t parse_metrics(std::string_view field) {
+    std::uint8_t metrics = 0;
+
+    for(auto name : split(field, '+')) {
+        if(name == "summary") {
+            metrics |= metric_summary;
+        } else if(name == "nests") {
+            metrics |= metric_nests;
+        } else if(name == "hash") {
+            metrics |= metric_hash;
+        } else {
+            throw std::runtime_error{std::format("Error: unknown metric '{}' in request", name)};
+        }
+    }
+
+    return metrics;
+}
+
+// The fields before the simulation's arguments
+constexpr std::size_t fixed_field_count = 6;
+
+void parse_run_request(std::string_view line, run_request& request) {
+    auto fields = split(line, ',');
+
+    if(fields[0] != "Run") throw std::runtime_error{std::format("Error: unknown request '{}'", fields[0])};
+    if(fields.size() < fixed_field_count) throw std::runtime_error{"Error: malformed Run request"};
+
+    request.id = parse_field<std::uint32_t>(fields[1]);
+    request.args.seed = parse_field<std::uint64_t>(fields[2]);
+    request.max_ticks = parse_field<tick_t>(fields[3]);
+    request.metrics = parse_metrics(fields[4]);
+
+    if(fields[5] != "-") request.map_path = std::filesystem::path{fields[5]};
+
+    auto& args = request.args;
+    auto idx = fixed_field_count;
+
+    // Reads the next argument into member, if there is one
+    auto next = [&]<typename T>(T& member) {
+        if(idx < fields.size()) member = parse_field<T>(fields[idx++]);
+    };
+
+    next(args.rows);
+    next(args.columns);
+    next(args.nest_count);
+    next(args.ant_count_per_nest);
+    next(args.hunger_increase_per_tick);
+    next(args.hunger_to_die);
+    next(args.food_taken);
+    next(args.food_resupply_rate);
+    next(args.max_food_supply);
+    next(args.food_per_new_ant);
+    next(args.food_hunger_ratio);
+    next(args.falloff_rate);
+    next(args.increase_rate);
+    next(args.type1_avoidance);
+    next(args.type2_avoidance);
+
+    if(idx != fields.size()) throw std::runtime_error{"Error: too many fields in Run request"};
+}
+
+// Appends value to buffer in little endian byte order
+template <typename T>
+static void append(std::vector<std::uint8_t>& buffer, T value) {
+    if constexpr(std::is_same_v<T, double>) {
+        append(buffer, std::bit_cast<std::uint64_t>(value));
+    } else {
+        for(auto i = 0uz; i < sizeof(T); i++) {
+            buffer.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+        }
+    }
+}
+
+// Starts a response, leaving room for its length
+static std::vector<std::uint8_t> begin_response(std::uint32_t id, std::uint8_t status) {
+    std::vector<std::uint8_t> buffer(sizeof(std::uint32_t));
+
+    append(buffer, id);
+    append(buffer, status);
+
+    return buffer;
+}
+
+// Fills in the length of the rest of the response
+static std::vector<std::uint8_t> end_response(std::vector<std::uint8_t> buffer) {
+    auto length = static_cast<std::uint32_t>(buffer.size() - sizeof(std::uint32_t));
+
+    for(auto i = 0uz; i < sizeof(length); i++) {
+        buffer[i] = static_cast<std::uint8_t>(length >> (i * 8));
+    }
+
+    return buffer;
+}
+
+std::vector<std::uint8_t> encode_run_response(std::uint32_t id, std::uint8_t metrics, const simulation& sim) {
+    auto buffer = begin_response(id, 0);
+
+    append(buffer, metrics);
+
+    if(metrics & metric_summary) {
+        append(buffer, sim.get_tick_count());
+        append(buffer, std::to_underlying(sim.get_termination_reason()));
+        append(buffer, static_cast<std::uint64_t>(sim.get_ants().size()));
+        append(buffer, sim.get_food_count());
+        append(buffer, static_cast<std::uint64_t>(sim.get_births()));
+        append(buffer, static_cast<std::uint64_t>(sim.get_deaths()));
+    }
+
+    if(metrics & metric_nests) {
+        auto nests = sim.get_nest_stats();
+
+        append(buffer, static_cast<std::uint8_t>(nests.size()));
+
+        for(const auto& nest : nests) {
+            append(buffer, static_cast<std::uint64_t>(nest.population));
+            append(buffer, static_cast<std::uint64_t>(nest.births));
+            append(buffer, static_cast<std::uint64_t>(nest.deaths));
+            append(buffer, nest.food_gathered);
+        }
+    }
+
+    // Hashing visits every tile, so it is only done when asked for
+    if(metrics & metric_hash) append(buffer, hash_state(sim));
+
+    return end_response(std::move(buffer));
+}
+
+std::vector<std::uint8_t> encode_error_response(std::uint32_t id, std::string_view message) {
+    auto buffer = begin_response(id, 1);
+
+    buffer.insert(buffer.end(), message.begin(), message.end());
+
+    return end_response(std::move(buffer));
+}
+
+} // namespace ant_sim
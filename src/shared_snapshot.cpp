@@ -0,0 +1,322 @@
+#include "shared_snapshot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define ANT_SIM_HAS_SHARED_MEMORY
+#endif
+
+namespace ant_sim {
+
+constexpr char snapshot_magic[8] = {'A', 'N', 'T', 'S', 'N', 'A', 'P', 0};
+constexpr std::uint32_t snapshot_version = 1;
+
+constexpr auto no_buffer = ~std::uint64_t{0};
+
+// Readers access these from other processes, so they must not need a lock
+static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free);
+
+// Rounds offset up to the next multiple of alignment
+static std::size_t align_up(std::size_t offset, std::size_t alignment) noexcept {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Lays out the header and buffers, filling in every size and offset
+static std::size_t lay_out(snapshot_header& header) {
+    auto tile_count = header.rows * header.columns;
+
+    auto offset = align_up(sizeof(snapshot_buffer_header), alignof(std::uint64_t));
+
+    header.tiles_offset = offset;
+    offset = align_up(offset + tile_count, alignof(float));
+
+    header.food_offset = offset;
+    offset += tile_count * sizeof(float);
+
+    header.planes_offset = offset;
+    offset = align_up(offset + header.plane_count * tile_count * sizeof(float), alignof(snapshot_ant));
+
+    header.ants_offset = offset;
+    offset = align_up(offset + header.ant_capacity * sizeof(snapshot_ant), alignof(snapshot_nest));
+
+    header.nests_offset = offset;
+    offset += header.nest_count * sizeof(snapshot_nest);
+
+    // Each buffer starts on its own cache line, so the two are never written through the same line
+    header.buffer_size = align_up(offset, 64);
+
+    auto planes_end = sizeof(snapshot_header) + header.plane_count * sizeof(snapshot_plane);
+
+    header.buffer_offsets[0] = align_up(planes_end, 64);
+    header.buffer_offsets[1] = header.buffer_offsets[0] + header.buffer_size;
+
+    return header.buffer_offsets[1] + header.buffer_size;
+}
+
+// Fills in the parts of a header that only depend on the options and the size of the world
+static snapshot_header make_header(const snapshot_options& options, std::size_t rows, std::size_t columns,
+                                   std::size_t nest_count) {
+    snapshot_header header{};
+
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version = snapshot_version;
+    header.plane_count = static_cast<std::uint32_t>(options.pheromone_planes.size());
+    header.rows = rows;
+    header.columns = columns;
+    header.nest_count = nest_count;
+    header.ant_capacity = options.ant_capacity;
+    header.latest_buffer = no_buffer;
+
+    return header;
+}
+
+static std::size_t resolve_ant_capacity(std::size_t ant_capacity, std::size_t starting_population) noexcept {
+    return ant_capacity != 0 ? ant_capacity : std::max(starting_population * 4, std::size_t{1024});
+}
+
+std::size_t snapshot_publisher::bytes_required(snapshot_options options, const simulation_args_t& args) {
+    auto starting_population = static_cast<std::size_t>(args.nest_count) * args.ant_count_per_nest;
+
+    options.ant_capacity = resolve_ant_capacity(options.ant_capacity, starting_population);
+
+    auto header = make_header(options, args.rows, args.columns, args.nest_count);
+
+    return lay_out(header);
+}
+
+snapshot_publisher::snapshot_publisher(snapshot_options snapshot_options, const simulation& sim)
+    : options{std::move(snapshot_options)} {
+    auto nest_count = sim.get_nests().size();
+
+    for(auto [nest_id, type] : options.pheromone_planes) {
+        if(nest_id >= nest_count || type >= pheromone_type_count) {
+            throw std::runtime_error{
+                std::format("Error: there is no pheromone trail {}:{} to snapshot", nest_id, type)};
+        }
+    }
+
+    options.ant_capacity = resolve_ant_capacity(options.ant_capacity, sim.get_ants().size());
+
+    options.interval = std::max(options.interval, tick_t{1});
+
+    auto tiles = sim.get_tiles();
+    auto contents = sim.get_tile_contents();
+    auto rows = tiles.extent(0);
+    auto columns = tiles.extent(1);
+
+    auto header = make_header(options, rows, columns, nest_count);
+
+    region_size = lay_out(header);
+
+    stale_tiles[0] = dirty_tiles{rows, columns};
+    stale_tiles[1] = dirty_tiles{rows, columns};
+    trail_tiles = dirty_tiles{rows, columns};
+
+    // Trails left before the publisher was created are found once here, and after that from the changed tiles
+    if(!options.pheromone_planes.empty()) {
+        for(auto y = 0uz; y < rows; y++) {
+            for(auto x = 0uz; x < columns; x++) {
+                if(contents[y, x].pheromones.entry_count() != 0) trail_tiles.mark({x, y});
+            }
+        }
+    }
+
+#ifdef ANT_SIM_HAS_SHARED_MEMORY
+    auto error = [&](std::string_view reason) {
+        return std::runtime_error{std::format("Error: could not {} shared memory {}", reason, options.name)};
+    };
+
+    // A run that crashed leaves its object behind, and it may have a different size
+    shm_unlink(options.name.c_str());
+
+    auto fd = shm_open(options.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if(fd < 0) throw error("create");
+
+    if(ftruncate(fd, static_cast<off_t>(region_size)) != 0) {
+        close(fd);
+        shm_unlink(options.name.c_str());
+        throw error("size");
+    }
+
+    auto* mapping = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    // The mapping keeps the object open
+    close(fd);
+
+    if(mapping == MAP_FAILED) {
+        shm_unlink(options.name.c_str());
+        throw error("map");
+    }
+
+    region = static_cast<std::byte*>(mapping);
+#else
+    throw std::runtime_error{"Error: shared snapshots need POSIX shared memory, which isn't available here"};
+#endif
+
+    // The object starts zeroed, so both buffers start with an even sequence
+    std::memcpy(region, &header, sizeof(header));
+    std::memcpy(region + sizeof(header), options.pheromone_planes.data(),
+                options.pheromone_planes.size() * sizeof(snapshot_plane));
+
+    // Both buffers start with the whole world, so that later snapshots only have to copy the tiles that changed
+    publish(sim, true);
+    publish(sim, true);
+
+    // Both buffers hold the same snapshot
+    snapshots_published = 1;
+}
+
+snapshot_publisher::~snapshot_publisher() {
+#ifdef ANT_SIM_HAS_SHARED_MEMORY
+    if(region) {
+        munmap(region, region_size);
+        shm_unlink(options.name.c_str());
+    }
+#endif
+}
+
+void snapshot_publisher::after_tick(const simulation& sim) {
+    auto contents = sim.get_tile_contents();
+    auto track_trails = !options.pheromone_planes.empty();
+
+    // The simulation forgets the tiles a tick changed once the next tick starts, so they are kept for both buffers
+    // Pheromones are only left on tiles that ants move off, which are always among the changed tiles
+    for(auto location : sim.get_dirty_tiles().get_tiles()) {
+        stale_tiles[0].mark(location);
+        stale_tiles[1].mark(location);
+
+        if(track_trails && contents[location.y, location.x].pheromones.entry_count() != 0) {
+            trail_tiles.mark(location);
+        }
+    }
+
+    if(sim.get_tick_count() % options.interval == 0) publish(sim, false);
+}
+
+void snapshot_publisher::publish(const simulation& sim, bool whole_world) {
+    auto& header = get_header();
+
+    std::atomic_ref latest{header.latest_buffer};
+
+    // Write the buffer readers are least likely to be reading
+    auto index = latest.load(std::memory_order_relaxed) == 0 ? 1 : 0;
+    auto* buffer = region + header.buffer_offsets[index];
+
+    auto& buffer_header = *reinterpret_cast<snapshot_buffer_header*>(buffer);
+
+    std::atomic_ref sequence{buffer_header.sequence};
+
+    auto start_sequence = sequence.load(std::memory_order_relaxed);
+
+    // Readers that see the odd sequence, or that see it change, know the buffer was being written
+    sequence.store(start_sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto contents = sim.get_tile_contents();
+    auto rows = header.rows;
+    auto columns = header.columns;
+    auto tile_count = rows * columns;
+
+    auto* flags = reinterpret_cast<std::uint8_t*>(buffer + header.tiles_offset);
+    auto* food = reinterpret_cast<float*>(buffer + header.food_offset);
+    auto* planes = reinterpret_cast<float*>(buffer + header.planes_offset);
+
+    auto copy_tile = [&](point<> location) {
+        auto i = location.y * columns + location.x;
+
+        flags[i] = sim.get_tile_flags(location);
+        food[i] = sim.get_food_supply(location);
+    };
+
+    auto& stale = stale_tiles[index];
+
+    if(whole_world) {
+        for(auto y = 0uz; y < rows; y++) {
+            for(auto x = 0uz; x < columns; x++) {
+                copy_tile({x, y});
+            }
+        }
+    } else {
+        for(auto location : stale.get_tiles()) {
+            copy_tile(location);
+        }
+    }
+
+    stale.clear();
+
+    // Strengths fade every tick, so every tile with a trail is copied again
+    // Tiles that never had a trail keep the 0 the object started with
+    for(auto [x, y] : trail_tiles.get_tiles()) {
+        const auto& trails = contents[y, x].pheromones;
+
+        for(auto plane = 0uz; plane < options.pheromone_planes.size(); plane++) {
+            auto [nest_id, type] = options.pheromone_planes[plane];
+
+            planes[plane * tile_count + y * columns + x] =
+                sim.get_pheromone_strength(trails, static_cast<nest_id_t>(nest_id), type);
+        }
+    }
+
+    auto* ants = reinterpret_cast<snapshot_ant*>(buffer + header.ants_offset);
+    auto ants_stored = 0uz;
+
+    for(const auto& ant : sim.get_ants()) {
+        if(ants_stored == header.ant_capacity) break;
+
+        // clang-format off
+        ants[ants_stored++] = {
+            .x = static_cast<std::uint32_t>(ant.location.x),
+            .y = static_cast<std::uint32_t>(ant.location.y),
+            .ant_id = ant.ant_id,
+            .nest_id = ant.nest_id,
+            .caste = static_cast<std::uint8_t>(ant.caste),
+            .state = static_cast<std::uint8_t>(ant.state),
+            .padding = 0
+        };
+        // clang-format on
+    }
+
+    auto* nests = reinterpret_cast<snapshot_nest*>(buffer + header.nests_offset);
+    auto nest_stats = sim.get_nest_stats();
+
+    for(const auto& nest : sim.get_nests()) {
+        const auto& stats = nest_stats[nest.nest_id];
+
+        // clang-format off
+        nests[nest.nest_id] = {
+            .x = static_cast<std::uint32_t>(nest.location.x),
+            .y = static_cast<std::uint32_t>(nest.location.y),
+            .food_supply = nest.food_supply,
+            .padding = 0,
+            .population = stats.population,
+            .births = stats.births,
+            .deaths = stats.deaths,
+            .food_gathered = stats.food_gathered
+        };
+        // clang-format on
+    }
+
+    buffer_header.tick = sim.get_tick_count();
+    buffer_header.ant_count = sim.get_ants().size();
+    buffer_header.ants_stored = ants_stored;
+    buffer_header.food_count = sim.get_food_count();
+    buffer_header.births = sim.get_births();
+    buffer_header.deaths = sim.get_deaths();
+
+    sequence.store(start_sequence + 2, std::memory_order_release);
+    latest.store(static_cast<std::uint64_t>(index), std::memory_order_release);
+
+    snapshots_published++;
+}
+
+} // namespace ant_sim
@@ -1,6 +1,13 @@
 #include "simulation.hpp"
+#include "state_hash.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <string_view>
 #include <thread>
 
 #include <print>
@@ -8,44 +15,65 @@
 
 namespace ant_sim {
 
-std::minstd_rand get_rng(std::optional<std::uint64_t> seed) {
-    std::uint32_t seed_parts[2];
+// Returns seed if it has a value, otherwise a random seed
+std::uint64_t resolve_seed(std::optional<std::uint64_t> seed) {
+    if(seed) return *seed;
 
-    if(seed) {
-        // std::seed_seq only uses the low 32 bits of each input, so break the seed into 2 32 bit values
-        seed_parts[0] = *seed >> 32;
-        seed_parts[1] = *seed & 0xFFFFFFFF;
-    } else {
-        std::random_device random_device;
+    std::random_device random_device;
 
-        seed_parts[0] = random_device();
-        seed_parts[1] = random_device();
-    }
+    return static_cast<std::uint64_t>(random_device()) << 32 | random_device();
+}
 
-    std::seed_seq seed_seq{seed_parts[0], seed_parts[1]};
+std::minstd_rand get_rng(std::uint64_t seed) {
+    // std::seed_seq only uses the low 32 bits of each input, so break the seed into 2 32 bit values
+    std::uint32_t seed_parts[2] = {static_cast<std::uint32_t>(seed >> 32), static_cast<std::uint32_t>(seed)};
 
-    std::println("Seed,{}", static_cast<std::uint64_t>(seed_parts[0]) << 32 | seed_parts[1]);
+    std::seed_seq seed_seq{seed_parts[0], seed_parts[1]};
 
     return std::minstd_rand{seed_seq};
 }
 
-simulation::simulation(std::size_t rows, std::size_t columns, nest_id_t nest_count, ant_id_t ant_count_per_nest,
-                       std::optional<std::uint64_t> seed)
-    : rng{get_rng(seed)}, rows{rows}, columns{columns}, tiles(rows * columns) {
-    if(nest_count > tile::max_nests) {
-        auto error_string =
-            std::format("Error: {} nests is greater than the maximum of {}", nest_count, tile::max_nests);
-        throw std::runtime_error{error_string};
+// Replaces the size of the world and the number of nests with the world map's, if there is one
+static simulation_args_t apply_world_map(simulation_args_t args) {
+    if(args.map) {
+        args.rows = args.map->get_rows();
+        args.columns = args.map->get_columns();
+        args.nest_count = static_cast<nest_id_t>(args.map->get_nests().size());
     }
 
-    nests.reserve(nest_count);
-    ants.reserve(ant_count_per_nest);
+    return args;
+}
+
+simulation::simulation(const simulation_args_t& args, std::uint64_t seed)
+    : rng{get_rng(seed)}, tiles(args.rows, args.columns, args.tile_memory),
+      contents(args.rows, args.columns, args.tile_memory), seed{seed}, history{args.nest_count},
+      history_values(history.get_series_count()), dirty{args.rows, args.columns} {
+    // Set before the world is created, so that the seed and nests are only logged along with everything else
+    atomically_accessed.log_events = args.log_events;
+
+    if(args.log_events) {
+        std::println("Seed,{}", seed);
+    }
+
+#ifdef ANT_SIM_TILE_BORDER
+    tiles.fill_border(tile::make_border());
+#endif
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+    food_supplies = food_map{args.columns};
+#endif
 
-    generate(nest_count, ant_count_per_nest);
+    nests.reserve(args.nest_count);
+    ants.reserve(static_cast<std::size_t>(args.nest_count) * args.ant_count_per_nest);
+
+    if(args.map) {
+        load(*args.map, args.ant_count_per_nest);
+    } else {
+        generate(args.nest_count, args.ant_count_per_nest);
+    }
 }
 
-simulation::simulation(simulation_args_t args)
-    : simulation{args.rows, args.columns, args.nest_count, args.ant_count_per_nest, args.seed} {
+simulation::simulation(simulation_args_t args) : simulation{apply_world_map(args), resolve_seed(args.seed)} {
     hunger_increase_per_tick = args.hunger_increase_per_tick;
     hunger_to_die = args.hunger_to_die;
     food_taken = args.food_taken;
@@ -57,6 +85,12 @@ simulation::simulation(simulation_args_t args)
     increase_rate = args.increase_rate;
     type1_avoidance = args.type1_avoidance;
     type2_avoidance = args.type2_avoidance;
+
+    ant_sort_interval = args.ant_sort_interval;
+
+    termination = termination_monitor{args.termination};
+
+    estimated_memory = estimate_memory_usage(args);
 }
 
 void simulation::queue_ant(nest_id_t nest_id) {
@@ -68,39 +102,46 @@ void simulation::queue_ant(nest_id_t nest_id) {
         .location = nests[nest_id].location
     });
     // clang-format on
-
-    increment_births();
 }
 
 void simulation::add_ant(ant new_ant) {
-    auto [it, inserted] = ants.insert({new_ant.ant_id, new_ant});
-    assert(inserted);
+    ants.push_back(new_ant);
 
     nests[new_ant.nest_id].ant_count++;
 }
 
-void simulation::generate(nest_id_t nest_count, ant_id_t ant_count_per_nest) {
-    auto tiles = get_tiles();
+// The capacity reserved for food sources, which is enough that it almost never has to grow
+// The number placed is binomially distributed, so this allows for 4 standard deviations above the expected count
+static std::size_t food_source_capacity(std::size_t tile_count, float food_chance) {
+    auto chance = std::clamp(static_cast<double>(food_chance), 0.0, 1.0);
+    auto expected = static_cast<double>(tile_count) * chance;
+    auto deviation = std::sqrt(expected * (1 - chance));
 
-    std::uniform_int_distribution<std::size_t> location_dist_x{0, tiles.extent(1) - 1};
-    std::uniform_int_distribution<std::size_t> location_dist_y{0, tiles.extent(0) - 1};
+    return std::min(static_cast<std::size_t>(expected + 4 * deviation) + 1, tile_count);
+}
 
-    // Randomly place the nests across the world
-    for(nest_id_t i = 0; i < nest_count; i++) {
-        auto& nest = nests.emplace_back(i);
+void simulation::add_nest(point<> location) {
+    auto tiles = get_tiles();
 
-        auto x = location_dist_x(rng);
-        auto y = location_dist_y(rng);
+    auto nest_id = static_cast<nest_id_t>(nests.size());
+    auto& nest = nests.emplace_back(nest_id);
 
-        tiles[y, x].has_nest = true;
-        tiles[y, x].nest_id = i;
+    tiles[location.y, location.x].set_has_nest(true);
+    tiles[location.y, location.x].nest_id = nest_id;
 
-        nest.location = {x, y};
+    nest.location = location;
 
-        std::println("Nest,{},{},{}", i, y, x);
+    if(get_log_events()) {
+        std::println("Nest,{},{},{}", nest_id, location.y, location.x);
     }
+}
+
+void simulation::populate_nests(ant_id_t ant_count_per_nest) {
+    auto tiles = get_tiles();
+    auto contents = get_tile_contents();
+
+    nest_statistics.assign(nests.size(), {.population = ant_count_per_nest});
 
-    // Fill nests with ants
     for(auto& nest : nests) {
         for(auto i = 0uz; i < ant_count_per_nest; i++) {
             // Each nest has a single queen
@@ -108,101 +149,382 @@ void simulation::generate(nest_id_t nest_count, ant_id_t ant_count_per_nest) {
 
             auto ant_id = static_cast<ant_id_t>(nest.nest_id * ant_count_per_nest + i);
             // clang-format off
-            ants[ant_id] = {
+            ants.push_back({
                 .nest_id = nest.nest_id,
                 .ant_id = ant_id,
                 .caste = caste,
                 .location = nest.location,
                 .state = ant::state::searching,
                 .hunger = 0
-            };
+            });
             // clang-format on
 
             nest.ant_count++;
 
-            auto& tile = tiles[nest.location.y, nest.location.x];
-            tile.has_ant = true;
-            tile.ant_id = ant_id;
+            tiles[nest.location.y, nest.location.x].set_has_ant(true);
+            contents[nest.location.y, nest.location.x].ant_id = ant_id;
         }
     }
 
-    next_id = ant_count_per_nest * nest_count;
+    next_id = static_cast<ant_id_t>(ant_count_per_nest * nests.size());
+}
 
-    // Randomly place food across the world
-    std::uniform_real_distribution<float> food_dist{};
-
-    for(auto y = 0uz; y < tiles.extent(0); y++) {
-        for(auto x = 0uz; x < tiles.extent(1); x++) {
-            if(food_dist(rng) < food_chance) {
-                food_sources.push_back({x, y});
-                tiles[y, x].food_supply = 255;
-                set_food_count(get_food_count() + tiles[y, x].food_supply);
-            }
+void simulation::add_food_source(point<> location, food_supply_t supply) {
+    food_sources.push_back(location);
+    set_food_supply(location, supply);
+}
+
+void simulation::generate(nest_id_t nest_count, ant_id_t ant_count_per_nest) {
+    auto tiles = get_tiles();
+
+    std::uniform_int_distribution<std::size_t> location_dist_x{0, tiles.extent(1) - 1};
+    std::uniform_int_distribution<std::size_t> location_dist_y{0, tiles.extent(0) - 1};
+
+    // Every nest needs a tile of its own, otherwise placing them below would never finish
+    if(nest_count > tiles.size()) throw std::runtime_error{"Error: the world has fewer tiles than nests"};
+
+    // Randomly place the nests across the world
+    // A tile only holds one nest, so locations that are already taken are drawn again
+    for(nest_id_t i = 0; i < nest_count; i++) {
+        auto x = location_dist_x(rng);
+        auto y = location_dist_y(rng);
+
+        while(tiles[y, x].has_nest()) {
+            x = location_dist_x(rng);
+            y = location_dist_y(rng);
         }
+
+        add_nest({x, y});
+    }
+
+    populate_nests(ant_count_per_nest);
+
+    // Randomly place food across the world
+    // Rather than testing every tile, skip ahead by a geometrically distributed number of tiles to the next food source
+    // This makes the cost proportional to the amount of food placed, rather than to the size of the world
+    if(food_chance <= 0) return;
+
+    auto tile_count = tiles.size();
+
+    std::geometric_distribution<std::size_t> skip_dist{std::min(static_cast<double>(food_chance), 1.0)};
+
+    // std::geometric_distribution requires a probability below 1, but a probability of 1 means there is nothing to skip
+    auto next_skip = [&] { return food_chance >= 1 ? 0uz : skip_dist(rng); };
+
+    food_sources.reserve(food_source_capacity(tile_count, food_chance));
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+    food_supplies.reserve(food_sources.capacity());
+#endif
+
+    constexpr food_supply_t generated_food_supply = 255;
+
+    double food_placed = 0;
+
+    for(auto i = next_skip(); i < tile_count;) {
+        add_food_source({i % tiles.extent(1), i / tiles.extent(1)}, generated_food_supply);
+        food_placed += generated_food_supply;
+
+        auto skip = next_skip();
+
+        // Checked this way to avoid overflowing i
+        if(skip >= tile_count - i - 1) break;
+
+        i += skip + 1;
     }
+
+    set_food_count(get_food_count() + food_placed);
 }
 
-void simulation::update_pheromones(tile::pheromone_trails& pheromone_trails, tick_t current_tick, nest_id_t nest_id) {
-    for(auto i = 0uz; i < tile::pheromone_type_count; i++) {
-        auto& strength = pheromone_trails.pheromone_strength[nest_id][i];
-        auto& last_updated = pheromone_trails.last_updated[nest_id][i];
+void simulation::load(const world_map& map, ant_id_t ant_count_per_nest) {
+    auto tiles = get_tiles();
 
-        auto ticks_since_last_update = static_cast<float>(current_tick - last_updated);
+    auto error = [&](std::string_view reason) {
+        return std::runtime_error{std::format("Error: world map {} {}", map.get_path().string(), reason)};
+    };
 
-        last_updated = current_tick;
+    auto in_world = [&](std::size_t x, std::size_t y) { return x < tiles.extent(1) && y < tiles.extent(0); };
 
-        auto decrease = falloff_rate * ticks_since_last_update;
+    for(auto [x, y] : map.get_nests()) {
+        if(!in_world(x, y)) throw error("has a nest outside of the world");
 
-        if(falloff_rate * decrease > strength) {
-            strength = 0;
-        } else {
-            strength -= static_cast<pheromone_strength_t>(decrease);
-        }
+        // A tile only holds one nest id, so the first nest would be left without its tile
+        if(tiles[y, x].has_nest()) throw error("has two nests on the same tile");
+
+        add_nest({x, y});
     }
+
+    populate_nests(ant_count_per_nest);
+
+    auto food = map.get_food();
+
+    food_sources.reserve(food.size());
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+    food_supplies.reserve(food.size());
+#endif
+
+    double food_placed = 0;
+
+    for(auto [x, y, supply] : food) {
+        if(!in_world(x, y)) throw error("has a food source outside of the world");
+        if(!(supply > 0)) throw error("has a food source without any food");
+
+        // Each food source is resupplied every tick, so one listed twice would be resupplied twice as fast
+        if(has_food({x, y})) throw error("has two food sources on the same tile");
+
+        add_food_source({x, y}, supply);
+        food_placed += supply;
+    }
+
+    set_food_count(get_food_count() + food_placed);
+}
+
+// Compact pheromone ticks are 16 bit offsets from the epoch, so they must be rebased well before they overflow
+constexpr tick_t pheromone_rebase_interval = 1 << 15;
+
+void simulation::rebase_pheromones() {
+    auto current_tick = get_tick_count();
+
+    // Only tiles that some nest has marked have entries, so rebasing doesn't commit untouched pages
+    contents.for_each([&](tile_contents& cell) {
+        cell.pheromones.rebase(current_tick, falloff_rate, pheromone_epoch, current_tick, pheromone_pool);
+    });
+
+    pheromone_epoch = current_tick;
 }
 
 void simulation::tick() {
     if(paused()) return;
 
-    std::println("Tick,{},{},{}", ants.size(), get_tick_count(), get_food_count());
+    auto tick_start = std::chrono::steady_clock::now();
+
+    auto log_events = get_log_events();
+
+    if(log_events) {
+        std::println("Tick,{},{},{}", ants.size(), get_tick_count(), get_food_count());
+    }
+
+    counters.reset(nests.size());
+    dirty.clear();
 
-    for(auto it = ants.begin(); it != ants.end();) {
-        auto& ant = it->second;
+    if(ant_sort_interval != 0 && get_tick_count() % ant_sort_interval == 0) sort_ants();
 
-        ant.tick(*this);
+    // Survivors are moved down over the dead as the ants are ticked, which keeps them in order
+    auto survivors = ants.begin();
+
+    for(auto it = ants.begin(); it != ants.end(); ++it) {
+        auto& ant = *it;
+
+        ant.tick(*this, counters);
 
         if(ant.dead) {
-            std::println("Death,{},{},{},{}", ant.ant_id, ant.nest_id, ant.location.x, ant.location.y);
+            if(log_events) {
+                std::println("Death,{},{},{},{}", ant.ant_id, ant.nest_id, ant.location.x, ant.location.y);
+            }
 
-            it = ants.erase(it);
+            mark_dirty(ant.location);
         } else {
-            ++it;
+            // Nest populations are counted while ticking the ants, rather than in a separate pass
+            counters.record_survivor(ant.nest_id);
+
+            if(survivors != it) *survivors = ant;
+            ++survivors;
         }
     }
 
+    ants.erase(survivors, ants.end());
+
     for(auto& new_ant : new_ants) {
-        std::println("Birth,{},{},{},{}", new_ant.ant_id, new_ant.nest_id, new_ant.location.x, new_ant.location.y);
+        if(log_events) {
+            std::println("Birth,{},{},{},{}", new_ant.ant_id, new_ant.nest_id, new_ant.location.x,
+                         new_ant.location.y);
+        }
         add_ant(new_ant);
+        mark_dirty(new_ant.location);
+
+        counters.record_birth(new_ant.nest_id);
     }
 
     new_ants.clear();
 
-    for(auto [x, y] : food_sources) {
-        auto old_food_supply = get_tiles()[y, x].food_supply;
-        auto current_food_supply = get_tiles()[y, x].food_supply + food_resupply_rate;
-
-        get_tiles()[y, x].food_supply = std::min(current_food_supply, max_food_supply);
+    for(auto location : food_sources) {
+        auto old_food_supply = get_food_supply(location);
+        auto food_supply = std::min(old_food_supply + food_resupply_rate, max_food_supply);
 
-        auto food_diff = get_tiles()[y, x].food_supply - old_food_supply;
+        // Most food sources are already full, and don't need to be written or sent to consumers of the changes
+        if(food_supply != old_food_supply) {
+            set_food_supply(location, food_supply);
+            mark_dirty(location);
+        }
 
-        set_food_count(get_food_count() + food_diff);
+        counters.record_food_resupplied(food_supply - old_food_supply);
     }
 
+    publish_counters();
+
     ++std::atomic_ref{atomically_accessed.tick_count};
 
+    if constexpr(pheromone_encoding::uses_epoch) {
+        if(get_tick_count() - pheromone_epoch >= pheromone_rebase_interval) {
+            rebase_pheromones();
+        }
+    }
+
+    if(hash_interval != 0 && get_tick_count() % hash_interval == 0) {
+        std::println("Hash,{},{:016x}", get_tick_count(), hash_state(*this));
+    }
+
+    record_history(tick_start);
+
     if(get_state() == simulation_state::single_step) {
         pause(true);
     }
+
+    if(auto reason = termination.check(*this); reason != termination_reason::none) {
+        terminated_by = reason;
+        termination_tick = get_tick_count();
+
+        stop();
+    }
+}
+
+void simulation::sort_ants() {
+    auto key = [](const ant& ant) {
+        return morton_key(static_cast<std::uint32_t>(ant.location.x), static_cast<std::uint32_t>(ant.location.y));
+    };
+
+    std::ranges::sort(ants, [&](const ant& lhs, const ant& rhs) {
+        auto lhs_key = key(lhs);
+        auto rhs_key = key(rhs);
+
+        return lhs_key != rhs_key ? lhs_key < rhs_key : lhs.ant_id < rhs.ant_id;
+    });
+}
+
+const ant* simulation::find_ant(ant_id_t ant_id) const noexcept {
+    auto it = std::ranges::find(ants, ant_id, &ant::ant_id);
+
+    return it != ants.end() ? &*it : nullptr;
+}
+
+void simulation::publish_counters() {
+    // A single store per total, rather than one per change
+    set_food_count(get_food_count() + counters.food_change);
+
+    std::atomic_ref{atomically_accessed.births} += counters.births;
+    std::atomic_ref{atomically_accessed.deaths} += counters.deaths;
+
+    for(auto i = 0uz; i < nest_statistics.size(); i++) {
+        auto& stats = nest_statistics[i];
+        const auto& changes = counters.nests[i];
+
+        // Every ant born this tick has already been added
+        stats.population = changes.population + changes.births;
+        stats.births += changes.births;
+        stats.deaths += changes.deaths;
+        stats.food_gathered += changes.food_gathered;
+    }
+}
+
+void simulation::record_history(std::chrono::steady_clock::time_point tick_start) {
+    auto tick_time = std::chrono::duration<float, std::milli>{std::chrono::steady_clock::now() - tick_start};
+
+    history_values[stats_history::ant_count] = static_cast<float>(ants.size());
+    history_values[stats_history::food_count] = static_cast<float>(get_food_count());
+    history_values[stats_history::births] = static_cast<float>(counters.births);
+    history_values[stats_history::deaths] = static_cast<float>(counters.deaths);
+    history_values[stats_history::tick_time_ms] = tick_time.count();
+
+    for(const auto& nest : nests) {
+        auto population = nest_statistics[nest.nest_id].population;
+
+        history_values[stats_history::nest_population(nest.nest_id)] = static_cast<float>(population);
+        history_values[stats_history::nest_food(nest.nest_id)] = nest.food_supply;
+    }
+
+    history.record(history_values);
+}
+
+arena_stats simulation::get_tile_memory_stats() const {
+    auto tile_stats = tiles.memory_stats();
+    auto contents_stats = contents.memory_stats();
+
+    // clang-format off
+    return {
+        .size = tile_stats.size + contents_stats.size,
+        .resident_bytes = tile_stats.resident_bytes + contents_stats.resident_bytes,
+        .huge_page_bytes = tile_stats.huge_page_bytes + contents_stats.huge_page_bytes,
+        .kind = tile_stats.kind
+    };
+    // clang-format on
+}
+
+memory_usage simulation::get_memory_usage() const {
+    // Tiles also use the pool holding pheromone entries that overflow them, and the dirty tile bitmap
+    auto tile_bytes = get_tile_memory_stats().resident_bytes + pheromone_pool.memory_usage() + dirty.memory_usage();
+
+#ifdef ANT_SIM_VALIDATE_PHEROMONES
+    tile_bytes += exact_pheromone_pool.memory_usage();
+#endif
+
+    auto food_source_bytes = vector_bytes(food_sources);
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+    food_source_bytes += food_supplies.memory_usage();
+#endif
+
+    // clang-format off
+    return {
+        .tiles = tile_bytes,
+        .ants = vector_bytes(ants),
+        .food_sources = food_source_bytes,
+        .nests = vector_bytes(nests),
+        .new_ants = vector_bytes(new_ants),
+        .history = stats_history::bytes_required(nests.size()) + vector_bytes(history_values)
+    };
+    // clang-format on
+}
+
+memory_usage simulation::estimate_memory_usage(const simulation_args_t& unresolved_args) {
+    auto args = apply_world_map(unresolved_args);
+
+    auto tile_count = args.rows * args.columns;
+    auto ant_count = static_cast<std::size_t>(args.nest_count) * args.ant_count_per_nest;
+
+    auto ant_bytes = vector_bytes<ant>(ant_count);
+
+    // Each queen queues at most one ant per tick
+    auto new_ant_capacity = std::bit_ceil(static_cast<std::size_t>(args.nest_count));
+
+    // Leaves out the pheromone pool, which only grows where more nests than fit in a tile mark the same tile
+    auto tile_bytes = bordered_world_grid<tile>::bytes_required(args.rows, args.columns) +
+                      world_grid<tile_contents>::bytes_required(args.rows, args.columns) +
+                      (tile_count + 7) / 8; // The dirty tile bitmap, if every tile changed
+
+    auto history_bytes = stats_history::bytes_required(args.nest_count) +
+                         vector_bytes<float>(stats_history::series_count_for(args.nest_count));
+
+    // The food sources of a map are known, while generated ones are counted at the capacity reserved for them
+    auto food_source_count = args.map ? args.map->get_food().size()
+                                      : food_source_capacity(tile_count, default_food_chance);
+
+    auto food_source_bytes = vector_bytes<point<>>(food_source_count);
+
+#ifdef ANT_SIM_CHUNKED_WORLD
+    food_source_bytes += food_map::bytes_required(food_source_count);
+#endif
+
+    // clang-format off
+    return {
+        .tiles = tile_bytes,
+        .ants = ant_bytes,
+        .food_sources = food_source_bytes,
+        .nests = vector_bytes<nest>(args.nest_count),
+        .new_ants = vector_bytes<ant>(new_ant_capacity),
+        .history = history_bytes
+    };
+    // clang-format on
 }
 
 template <typename T>
@@ -250,13 +572,27 @@ void simulation::set_log_ant_state_changes(bool log_ant_state_changes) noexcept
     std::atomic_ref{atomically_accessed.log_ant_state_changes} = log_ant_state_changes;
 }
 
+bool simulation::get_log_events() const noexcept { return atomic_read(atomically_accessed.log_events); }
+
+void simulation::set_log_events(bool log_events) noexcept {
+    std::atomic_ref{atomically_accessed.log_events} = log_events;
+}
+
 tick_t simulation::get_tick_count() const noexcept { return atomic_read(atomically_accessed.tick_count); }
 
-[[nodiscard]] float simulation::get_food_count() const noexcept {
+float simulation::get_achieved_tick_rate() const noexcept {
+    return atomic_read(atomically_accessed.achieved_tick_rate);
+}
+
+void simulation::set_achieved_tick_rate(float achieved_tick_rate) noexcept {
+    std::atomic_ref{atomically_accessed.achieved_tick_rate} = achieved_tick_rate;
+}
+
+[[nodiscard]] double simulation::get_food_count() const noexcept {
     return atomic_read(atomically_accessed.food_count);
 }
 
-void simulation::set_food_count(float food_count) noexcept {
+void simulation::set_food_count(double food_count) noexcept {
     std::atomic_ref{atomically_accessed.food_count} = food_count;
 }
 
@@ -267,12 +603,4 @@ std::size_t simulation::get_deaths() const noexcept {
     return atomic_read(atomically_accessed.deaths);
 }
 
-void simulation::increment_births() noexcept {
-    ++std::atomic_ref{atomically_accessed.births};
-}
-
-void simulation::increment_deaths() noexcept {
-    ++std::atomic_ref{atomically_accessed.deaths};
-}
-
 } // namespace ant_sim
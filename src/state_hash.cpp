@@ -0,0 +1,142 @@
+#include "state_hash.hpp"
+
+#include <bit>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+
+namespace ant_sim {
+
+// The splitmix64 finalizer
+static constexpr std::uint64_t mix(std::uint64_t value) noexcept {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+
+    return value ^ (value >> 31);
+}
+
+// Hashes the fields of a single tile, pheromone entry, ant or nest
+// Items are combined by addition, so the order they are hashed in doesn't change the result
+class item_hasher {
+    std::uint64_t value;
+
+  public:
+    // kind keeps different types of items with the same fields from hashing the same
+    explicit item_hasher(std::uint64_t kind) noexcept : value{mix(kind)} {}
+
+    template <typename T>
+    void add(T field) noexcept {
+        if constexpr(std::is_enum_v<T>) {
+            add(std::to_underlying(field));
+        } else if constexpr(std::is_same_v<T, float>) {
+            add(std::bit_cast<std::uint32_t>(field));
+        } else if constexpr(std::is_same_v<T, double>) {
+            add(std::bit_cast<std::uint64_t>(field));
+        } else {
+            value = mix(value ^ static_cast<std::uint64_t>(field));
+        }
+    }
+
+    [[nodiscard]] std::uint64_t get() const noexcept { return value; }
+};
+
+std::uint64_t hash_state(const simulation& sim) {
+    std::uint64_t result = 0;
+
+    auto tiles = sim.get_tiles();
+    auto contents = sim.get_tile_contents();
+
+    auto epoch = sim.get_pheromone_epoch();
+
+    for(auto y = 0uz; y < tiles.extent(0); y++) {
+        for(auto x = 0uz; x < tiles.extent(1); x++) {
+            const auto& tile = tiles[y, x];
+            const auto& tile_contents = contents[y, x];
+
+            // Chunked worlds keep food outside of the tiles, so the flags are read through the simulation
+            auto flags = sim.get_tile_flags({x, y});
+
+            // Empty tiles are skipped, so that they don't have to be mixed in
+            if(flags == 0 && tile_contents.pheromones.entry_count() == 0) continue;
+
+            item_hasher hasher{0};
+
+            hasher.add(y);
+            hasher.add(x);
+            hasher.add(flags);
+
+            // Fields that are meaningless because of the flags are left out, as they may hold anything
+            if(tile.has_nest()) hasher.add(tile.nest_id);
+            if(tile.has_ant()) hasher.add(tile_contents.ant_id);
+            if(flags & tile::has_food_flag) hasher.add(sim.get_food_supply({x, y}));
+
+            result += hasher.get();
+
+            // Pheromones are hashed as stored, without decaying them to the current tick
+            // The order of a tile's entries depends on which nests faded first, so each entry is a separate item
+            tile_contents.pheromones.for_each_entry([&](const auto& entry) {
+                item_hasher entry_hasher{4};
+
+                entry_hasher.add(y);
+                entry_hasher.add(x);
+                entry_hasher.add(entry.nest_id);
+
+                for(auto i = 0uz; i < tile::pheromone_type_count; i++) {
+                    entry_hasher.add(entry.get_strength(i));
+                    entry_hasher.add(entry.get_last_updated(i, epoch));
+                }
+
+                result += entry_hasher.get();
+            });
+        }
+    }
+
+    // Ants are ticked in the order they are stored, so each is hashed along with its position in that order
+    auto ant_index = 0uz;
+
+    for(const auto& ant : sim.get_ants()) {
+        item_hasher hasher{1};
+
+        hasher.add(ant_index++);
+        hasher.add(ant.ant_id);
+        hasher.add(ant.nest_id);
+        hasher.add(ant.caste);
+        hasher.add(ant.location.x);
+        hasher.add(ant.location.y);
+        hasher.add(ant.state);
+        hasher.add(ant.dead);
+        hasher.add(ant.hunger);
+        hasher.add(ant.food_in_inventory);
+
+        result += hasher.get();
+    }
+
+    for(const auto& nest : sim.get_nests()) {
+        item_hasher hasher{2};
+
+        hasher.add(nest.nest_id);
+        hasher.add(nest.ant_count);
+        hasher.add(nest.location.x);
+        hasher.add(nest.location.y);
+        hasher.add(nest.food_supply);
+
+        result += hasher.get();
+    }
+
+    // minstd_rand only exposes its state through its stream operators
+    std::stringstream rng_stream;
+    rng_stream << sim.rng;
+
+    std::minstd_rand::result_type rng_state = 0;
+    rng_stream >> rng_state;
+
+    item_hasher hasher{3};
+
+    hasher.add(sim.get_tick_count());
+    hasher.add(sim.get_food_count());
+    hasher.add(rng_state);
+
+    return result + hasher.get();
+}
+
+} // namespace ant_sim
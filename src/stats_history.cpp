@@ -0,0 +1,101 @@
+#include "stats_history.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace ant_sim {
+
+stats_history::stats_history(std::size_t nest_count)
+    : series_count{series_count_for(nest_count)}, samples(series_count * capacity),
+      pending_sums(series_count) {}
+
+// Samples are always accessed atomically, as readers may be copying them while they are written
+// libc++ doesn't support atomic_ref<T> with const T yet, so reading uses a const_cast
+// This is safe because no attempt is made to modify the value
+float stats_history::load(std::size_t index) const noexcept {
+    return std::atomic_ref{const_cast<float&>(samples[index])}.load(std::memory_order_relaxed);
+}
+
+void stats_history::store(std::size_t index, float value) noexcept {
+    std::atomic_ref{samples[index]}.store(value, std::memory_order_relaxed);
+}
+
+void stats_history::record(std::span<const float> values) noexcept {
+    for(auto i = 0uz; i < series_count; i++) {
+        pending_sums[i] += values[i];
+    }
+
+    pending_ticks++;
+
+    if(pending_ticks < stride.load(std::memory_order_relaxed)) return;
+
+    // Publish the mean of the pending ticks as a sample, as a single write section of the sequence lock
+    auto before = sequence.load(std::memory_order_relaxed);
+    sequence.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    append();
+
+    // Merge as soon as the series are full, so that the next sample is collected with the new stride
+    if(count.load(std::memory_order_relaxed) == capacity) {
+        merge_pairs();
+    }
+
+    sequence.store(before + 2, std::memory_order_release);
+
+    std::ranges::fill(pending_sums, 0.0);
+    pending_ticks = 0;
+}
+
+void stats_history::append() noexcept {
+    auto index = count.load(std::memory_order_relaxed);
+
+    for(auto series = 0uz; series < series_count; series++) {
+        store(series * capacity + index, static_cast<float>(pending_sums[series] / pending_ticks));
+    }
+
+    count.store(index + 1, std::memory_order_relaxed);
+}
+
+void stats_history::merge_pairs() noexcept {
+    for(auto series = 0uz; series < series_count; series++) {
+        auto base = series * capacity;
+
+        for(auto i = 0uz; i < capacity / 2; i++) {
+            store(base + i, (load(base + i * 2) + load(base + i * 2 + 1)) / 2);
+        }
+    }
+
+    count.store(capacity / 2, std::memory_order_relaxed);
+    stride.store(stride.load(std::memory_order_relaxed) * 2, std::memory_order_relaxed);
+}
+
+void stats_history::read(snapshot& result) const {
+    result.samples.resize(series_count * capacity);
+
+    while(true) {
+        auto before = sequence.load(std::memory_order_acquire);
+
+        // The tick thread is partway through writing, so wait for it to finish
+        if(before % 2 != 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        result.count = count.load(std::memory_order_relaxed);
+        result.stride = stride.load(std::memory_order_relaxed);
+
+        for(auto series = 0uz; series < series_count; series++) {
+            for(auto i = 0uz; i < result.count; i++) {
+                result.samples[series * capacity + i] = load(series * capacity + i);
+            }
+        }
+
+        // Make sure the copy is complete before checking whether the tick thread wrote in the meantime
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if(sequence.load(std::memory_order_relaxed) == before) return;
+    }
+}
+
+} // namespace ant_sim
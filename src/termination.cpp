@@ -0,0 +1,79 @@
+#include "termination.hpp"
+
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace ant_sim {
+
+const char* to_string(termination_reason reason) noexcept {
+    switch(reason) {
+    case termination_reason::none:
+        return "none";
+    case termination_reason::collapse:
+        return "collapse";
+    case termination_reason::steady_state:
+        return "steady_state";
+    default:
+        std::unreachable();
+    }
+}
+
+double running_stats::standard_deviation() const noexcept { return std::sqrt(variance()); }
+
+bool termination_monitor::has_collapsed(const simulation& sim) const noexcept {
+    auto nests = sim.get_nests();
+
+    // Every nest keeps its queen, so there can only be no workers if there are no more ants than nests
+    if(sim.get_ants().size() > nests.size()) return false;
+
+    for(const auto& ant : sim.get_ants()) {
+        if(ant.caste != ant::caste::queen) return false;
+    }
+
+    for(const auto& nest : nests) {
+        if(nest.food_supply >= sim.food_per_new_ant) return false;
+    }
+
+    return true;
+}
+
+// Checks if two windows have means and standard deviations within tolerance of each other
+static bool windows_match(const running_stats& current, const running_stats& previous, double tolerance) noexcept {
+    // Measure differences relative to the mean, but don't let a mean near 0 make every difference look huge
+    auto scale = std::max(std::abs(previous.mean), 1.0);
+
+    auto mean_difference = std::abs(current.mean - previous.mean);
+    auto deviation_difference = std::abs(current.standard_deviation() - previous.standard_deviation());
+
+    return mean_difference <= tolerance * scale && deviation_difference <= tolerance * scale;
+}
+
+bool termination_monitor::is_steady(const simulation& sim) noexcept {
+    population.add(static_cast<double>(sim.get_ants().size()));
+    food.add(sim.get_food_count());
+
+    if(population.count < policy.steady_state_window) return false;
+
+    // Only compare once there is a full previous window to compare with
+    auto steady = previous_population.count == policy.steady_state_window &&
+                  windows_match(population, previous_population, policy.steady_state_tolerance) &&
+                  windows_match(food, previous_food, policy.steady_state_tolerance);
+
+    previous_population = std::exchange(population, {});
+    previous_food = std::exchange(food, {});
+
+    return steady;
+}
+
+termination_reason termination_monitor::check(const simulation& sim) noexcept {
+    if(policy.stop_on_collapse && has_collapsed(sim)) return termination_reason::collapse;
+
+    if(policy.steady_state_window != 0 && is_steady(sim)) return termination_reason::steady_state;
+
+    return termination_reason::none;
+}
+
+} // namespace ant_sim
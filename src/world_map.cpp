@@ -0,0 +1,170 @@
+#include "world_map.hpp"
+
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ANT_SIM_HAS_MMAP
+#endif
+
+namespace ant_sim {
+
+constexpr char world_map_magic[8] = {'A', 'N', 'T', 'M', 'A', 'P', 0, 0};
+constexpr std::uint32_t world_map_version = 1;
+
+constexpr std::size_t nests_offset = sizeof(world_map_header);
+
+static_assert(nests_offset % alignof(world_map_nest) == 0);
+static_assert(sizeof(world_map_nest) % alignof(world_map_food) == 0);
+
+static std::size_t get_food_offset(std::uint64_t nest_count) noexcept {
+    return nests_offset + nest_count * sizeof(world_map_nest);
+}
+
+// Unmaps a file mapped by world_map, which is a no-op when it was read into memory instead
+static void unmap(const std::byte* data, std::size_t size) noexcept {
+#ifdef ANT_SIM_HAS_MMAP
+    if(data) munmap(const_cast<std::byte*>(data), size);
+#endif
+}
+
+static std::uint64_t fnv1a(std::span<const std::byte> bytes, std::uint64_t hash = 0xcbf29ce484222325) noexcept {
+    for(auto byte : bytes) {
+        hash = (hash ^ static_cast<std::uint8_t>(byte)) * 0x100000001b3;
+    }
+
+    return hash;
+}
+
+world_map::world_map(const std::filesystem::path& path) : path{path} {
+    // Maps are used in place, so they can only be read on machines with the byte order they are written in
+    if constexpr(std::endian::native != std::endian::little) {
+        throw std::runtime_error{"Error: world maps can only be read on little endian machines"};
+    }
+
+    auto error = [&](std::string_view reason) {
+        return std::runtime_error{std::format("Error: could not read world map {}: {}", path.string(), reason)};
+    };
+
+#ifdef ANT_SIM_HAS_MMAP
+    auto fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0) throw error("could not open the file");
+
+    struct stat file_stat{};
+
+    if(fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(sizeof(world_map_header))) {
+        ::close(fd);
+        throw error("the file is too small");
+    }
+
+    size = static_cast<std::size_t>(file_stat.st_size);
+
+    // A shared mapping of a read-only file, so every process using the map shares its pages in the page cache
+    auto* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping keeps the file open
+    ::close(fd);
+
+    if(mapping == MAP_FAILED) throw error("could not map the file");
+
+    data = static_cast<const std::byte*>(mapping);
+#else
+    std::ifstream file{path, std::ios::binary | std::ios::ate};
+
+    if(!file) throw error("could not open the file");
+
+    contents.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+
+    if(!file || contents.size() < sizeof(world_map_header)) throw error("the file is too small");
+
+    data = contents.data();
+    size = contents.size();
+#endif
+
+    // Only the header is checked, so opening a map takes the same time no matter how large it is
+    const auto& header = get_header();
+
+    auto invalid = [&](std::string_view reason) {
+        // The destructor doesn't run when the constructor throws
+        unmap(data, size);
+        return error(reason);
+    };
+
+    if(std::memcmp(header.magic, world_map_magic, sizeof(world_map_magic)) != 0) throw invalid("not a world map");
+    if(header.version != world_map_version) throw invalid("unsupported version");
+
+    if(header.nest_count > std::numeric_limits<nest_id_t>::max()) throw invalid("too many nests");
+
+    auto food_offset = get_food_offset(header.nest_count);
+
+    if(header.food_count > (std::numeric_limits<std::size_t>::max() - food_offset) / sizeof(world_map_food) ||
+       size != food_offset + header.food_count * sizeof(world_map_food)) {
+        throw invalid("the file's size doesn't match its header");
+    }
+}
+
+world_map::~world_map() {
+    unmap(data, size);
+}
+
+std::span<const world_map_nest> world_map::get_nests() const noexcept {
+    return {reinterpret_cast<const world_map_nest*>(data + nests_offset), get_header().nest_count};
+}
+
+std::span<const world_map_food> world_map::get_food() const noexcept {
+    const auto& header = get_header();
+
+    return {reinterpret_cast<const world_map_food*>(data + get_food_offset(header.nest_count)), header.food_count};
+}
+
+void write_world_map(const std::filesystem::path& path, std::size_t rows, std::size_t columns,
+                     std::span<const world_map_nest> nests, std::span<const world_map_food> food) {
+    if(nests.size() > std::numeric_limits<nest_id_t>::max()) {
+        throw std::runtime_error{std::format("Error: a world map can't have more than {} nests",
+                                             std::numeric_limits<nest_id_t>::max())};
+    }
+
+    // Locations are stored in 32 bits
+    constexpr std::size_t max_extent = std::size_t{std::numeric_limits<std::uint32_t>::max()} + 1;
+
+    if(rows > max_extent || columns > max_extent) {
+        throw std::runtime_error{"Error: a world map can't be more than 2^32 tiles wide or high"};
+    }
+
+    auto nest_bytes = std::as_bytes(nests);
+    auto food_bytes = std::as_bytes(food);
+
+    world_map_header header{};
+
+    std::memcpy(header.magic, world_map_magic, sizeof(world_map_magic));
+    header.version = world_map_version;
+    header.nest_count = static_cast<std::uint32_t>(nests.size());
+    header.rows = rows;
+    header.columns = columns;
+    header.food_count = food.size();
+    header.checksum = fnv1a(food_bytes, fnv1a(nest_bytes));
+
+    std::ofstream file{path, std::ios::binary};
+
+    if(!file) throw std::runtime_error{std::format("Error: could not open {} to write a world map", path.string())};
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(nest_bytes.data()), static_cast<std::streamsize>(nest_bytes.size()));
+    file.write(reinterpret_cast<const char*>(food_bytes.data()), static_cast<std::streamsize>(food_bytes.size()));
+
+    if(!file) throw std::runtime_error{std::format("Error: could not write the world map {}", path.string())};
+}
+
+} // namespace ant_sim
@@ -0,0 +1,589 @@
+#include <ant_sim_project/pheromones.hpp>
+#include <ant_sim_project/result_cache.hpp>
+#include <ant_sim_project/service_protocol.hpp>
+#include <ant_sim_project/simulation.hpp>
+#include <ant_sim_project/stats_history.hpp>
+#include <ant_sim_project/world_map.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace ant_sim;
+
+// A file in the temporary directory, named after the running test, which is removed once the test finishes
+class temporary_file {
+    std::filesystem::path path;
+
+  public:
+    explicit temporary_file(std::string_view extension) {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+
+        path = std::filesystem::temp_directory_path() /
+               std::format("ant_sim_{}_{}{}", test->test_suite_name(), test->name(), extension);
+
+        std::filesystem::remove(path);
+    }
+
+    temporary_file(const temporary_file&) = delete;
+    temporary_file& operator=(const temporary_file&) = delete;
+
+    ~temporary_file() { std::filesystem::remove(path); }
+
+    [[nodiscard]] const std::filesystem::path& get_path() const noexcept { return path; }
+};
+
+// Arguments for a small world that doesn't log anything
+simulation_args_t quiet_args(std::uint64_t seed) {
+    simulation_args_t args = {};
+    args.seed = seed;
+    args.rows = 20;
+    args.columns = 30;
+    args.log_events = false;
+
+    return args;
+}
+
+run_summary make_summary() {
+    run_summary summary = {};
+    summary.ticks = 120;
+    summary.termination = termination_reason::collapse;
+    summary.ant_count = 17;
+    summary.food_count = 1234.5;
+    summary.births = 8;
+    summary.deaths = 11;
+    summary.state_hash = 0x0123456789abcdef;
+    summary.nests = {{.population = 9, .births = 3, .deaths = 4, .food_gathered = 50.25},
+                     {.population = 8, .births = 5, .deaths = 7, .food_gathered = 0.5}};
+
+    return summary;
+}
+
+void expect_same_summary(const run_summary& actual, const run_summary& expected) {
+    EXPECT_EQ(actual.ticks, expected.ticks);
+    EXPECT_EQ(actual.termination, expected.termination);
+    EXPECT_EQ(actual.ant_count, expected.ant_count);
+    EXPECT_EQ(actual.food_count, expected.food_count);
+    EXPECT_EQ(actual.births, expected.births);
+    EXPECT_EQ(actual.deaths, expected.deaths);
+    EXPECT_EQ(actual.state_hash, expected.state_hash);
+
+    ASSERT_EQ(actual.nests.size(), expected.nests.size());
+
+    for(auto i = 0uz; i < expected.nests.size(); i++) {
+        EXPECT_EQ(actual.nests[i].population, expected.nests[i].population);
+        EXPECT_EQ(actual.nests[i].births, expected.nests[i].births);
+        EXPECT_EQ(actual.nests[i].deaths, expected.nests[i].deaths);
+        EXPECT_EQ(actual.nests[i].food_gathered, expected.nests[i].food_gathered);
+    }
+}
+
+void append_to(const std::filesystem::path& path, std::string_view text) {
+    std::ofstream file{path, std::ios::binary | std::ios::app};
+    file << text;
+}
+
+// Result cache
+
+TEST(result_cache, reloads_stored_results) {
+    temporary_file file{".cache"};
+
+    auto args = quiet_args(7);
+    auto summary = make_summary();
+
+    {
+        result_cache cache{file.get_path()};
+
+        EXPECT_EQ(cache.find(args, 100), nullptr);
+
+        cache.store(args, 100, summary);
+
+        ASSERT_NE(cache.find(args, 100), nullptr);
+    }
+
+    result_cache reloaded{file.get_path()};
+
+    EXPECT_EQ(reloaded.size(), 1);
+    EXPECT_EQ(reloaded.get_skipped_lines(), 0);
+
+    const auto* found = reloaded.find(args, 100);
+
+    ASSERT_NE(found, nullptr);
+    expect_same_summary(*found, summary);
+
+    // Anything that changes how the run plays out is a different run
+    EXPECT_EQ(reloaded.find(args, 101), nullptr);
+
+    args.falloff_rate *= 2;
+    EXPECT_EQ(reloaded.find(args, 100), nullptr);
+}
+
+TEST(result_cache, skips_a_cut_off_last_line) {
+    temporary_file file{".cache"};
+
+    auto first = quiet_args(1);
+    auto second = quiet_args(2);
+    auto summary = make_summary();
+
+    {
+        result_cache cache{file.get_path()};
+        cache.store(first, 100, summary);
+    }
+
+    // A record cut off by a crash, without its newline
+    append_to(file.get_path(), std::format("Result,{:016x},v1;2;100", make_run_key(second, 100)));
+
+    {
+        result_cache cache{file.get_path()};
+
+        EXPECT_EQ(cache.size(), 1);
+        EXPECT_EQ(cache.get_skipped_lines(), 1);
+        EXPECT_NE(cache.find(first, 100), nullptr);
+        EXPECT_EQ(cache.find(second, 100), nullptr);
+
+        // Written on a line of its own, after the cut off one
+        cache.store(second, 100, summary);
+    }
+
+    result_cache reloaded{file.get_path()};
+
+    EXPECT_EQ(reloaded.size(), 2);
+    EXPECT_EQ(reloaded.get_skipped_lines(), 1);
+    EXPECT_NE(reloaded.find(first, 100), nullptr);
+    EXPECT_NE(reloaded.find(second, 100), nullptr);
+}
+
+TEST(result_cache, rejects_a_colliding_description) {
+    temporary_file file{".cache"};
+
+    auto args = quiet_args(3);
+
+    // A record under the run's key, but for some other run
+    auto record = std::format("Result,{:016x},some other run,10,none,5,1.5,2,3,0000000000000000,0\n",
+                              make_run_key(args, 100));
+    append_to(file.get_path(), record);
+
+    result_cache cache{file.get_path()};
+
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_EQ(cache.get_skipped_lines(), 0);
+    EXPECT_EQ(cache.find(args, 100), nullptr);
+}
+
+TEST(result_cache, needs_a_fixed_seed) {
+    auto args = quiet_args(0);
+    args.seed.reset();
+
+    EXPECT_THROW((void)describe_run(args, 100), std::runtime_error);
+}
+
+// Service requests
+
+TEST(parse_run_request, reads_the_fixed_fields) {
+    run_request request;
+
+    parse_run_request("Run,7,42,100,summary+hash,-", request);
+
+    EXPECT_EQ(request.id, 7);
+    EXPECT_EQ(request.args.seed, 42);
+    EXPECT_EQ(request.max_ticks, 100);
+    EXPECT_EQ(request.metrics, metric_summary | metric_hash);
+    EXPECT_FALSE(request.map_path);
+}
+
+TEST(parse_run_request, keeps_defaults_for_fields_left_out) {
+    run_request request;
+
+    parse_run_request("Run,1,2,3,nests,maps/world.map,50,60", request);
+
+    simulation_args_t defaults = {};
+
+    EXPECT_EQ(request.map_path, std::filesystem::path{"maps/world.map"});
+    EXPECT_EQ(request.args.rows, 50);
+    EXPECT_EQ(request.args.columns, 60);
+    EXPECT_EQ(request.args.nest_count, defaults.nest_count);
+    EXPECT_EQ(request.args.ant_count_per_nest, defaults.ant_count_per_nest);
+    EXPECT_EQ(request.args.hunger_to_die, defaults.hunger_to_die);
+    EXPECT_EQ(request.args.falloff_rate, defaults.falloff_rate);
+    EXPECT_EQ(request.args.type2_avoidance, defaults.type2_avoidance);
+}
+
+TEST(parse_run_request, reads_every_argument) {
+    run_request request;
+
+    parse_run_request("Run,1,2,3,summary,-,10,11,3,4,1.5,200,25,6,700,80,2,0.5,9,0.25,0.75", request);
+
+    const auto& args = request.args;
+
+    EXPECT_EQ(args.rows, 10);
+    EXPECT_EQ(args.columns, 11);
+    EXPECT_EQ(args.nest_count, 3);
+    EXPECT_EQ(args.ant_count_per_nest, 4);
+    EXPECT_EQ(args.hunger_increase_per_tick, 1.5f);
+    EXPECT_EQ(args.hunger_to_die, 200);
+    EXPECT_EQ(args.food_taken, 25);
+    EXPECT_EQ(args.food_resupply_rate, 6);
+    EXPECT_EQ(args.max_food_supply, 700);
+    EXPECT_EQ(args.food_per_new_ant, 80);
+    EXPECT_EQ(args.food_hunger_ratio, 2);
+    EXPECT_EQ(args.falloff_rate, 0.5f);
+    EXPECT_EQ(args.increase_rate, 9);
+    EXPECT_EQ(args.type1_avoidance, 0.25f);
+    EXPECT_EQ(args.type2_avoidance, 0.75f);
+}
+
+TEST(parse_run_request, rejects_malformed_requests) {
+    const char* malformed[] = {
+        "Walk,1,2,3,summary,-",                                                 // Not a Run request
+        "Run,1,2,3,summary",                                                    // Too few fields
+        "Run,1,x,3,summary,-",                                                  // Seed isn't a number
+        "Run,1,2,-3,summary,-",                                                 // Negative tick limit
+        "Run,1,2,3,summary+sizes,-",                                            // Unknown metric
+        "Run,1,2,3,summary,-,10x",                                              // Trailing characters
+        "Run,1,2,3,summary,-,10,10,300",                                        // Too many nests for a nest id
+        "Run,1,2,3,summary,-,10,11,3,4,1.5,200,25,6,700,80,2,0.5,9,0.25,0.75,1" // Too many fields
+    };
+
+    for(const auto* line : malformed) {
+        run_request request;
+
+        EXPECT_THROW(parse_run_request(line, request), std::runtime_error) << line;
+    }
+}
+
+TEST(parse_run_request, reads_the_id_before_failing) {
+    run_request request;
+
+    EXPECT_THROW(parse_run_request("Run,9,x,3,summary,-", request), std::runtime_error);
+    EXPECT_EQ(request.id, 9);
+}
+
+// World maps
+
+TEST(world_map, round_trips_through_a_file) {
+    temporary_file file{".map"};
+
+    std::vector<world_map_nest> nests = {{1, 2}, {3, 4}};
+    std::vector<world_map_food> food = {{5, 6, 100}, {7, 8, 255}};
+
+    write_world_map(file.get_path(), 10, 20, nests, food);
+
+    world_map map{file.get_path()};
+
+    EXPECT_EQ(map.get_rows(), 10);
+    EXPECT_EQ(map.get_columns(), 20);
+
+    ASSERT_EQ(map.get_nests().size(), 2);
+    EXPECT_EQ(map.get_nests()[1].x, 3);
+    EXPECT_EQ(map.get_nests()[1].y, 4);
+
+    ASSERT_EQ(map.get_food().size(), 2);
+    EXPECT_EQ(map.get_food()[0].x, 5);
+    EXPECT_EQ(map.get_food()[0].y, 6);
+    EXPECT_EQ(map.get_food()[0].supply, 100);
+
+    // The checksum identifies the contents, so changing any of them changes it
+    temporary_file other{".other.map"};
+    food[1].supply = 254;
+
+    write_world_map(other.get_path(), 10, 20, nests, food);
+
+    EXPECT_NE(world_map{other.get_path()}.get_checksum(), map.get_checksum());
+}
+
+TEST(world_map, rejects_a_bad_header) {
+    temporary_file file{".map"};
+
+    write_world_map(file.get_path(), 10, 10, {}, {});
+
+    // Overwrite the magic
+    {
+        std::fstream map_file{file.get_path(), std::ios::binary | std::ios::in | std::ios::out};
+        map_file.write("NOTAMAP", 7);
+    }
+
+    EXPECT_THROW(world_map{file.get_path()}, std::runtime_error);
+}
+
+TEST(world_map, rejects_a_file_too_small_for_a_header) {
+    temporary_file file{".map"};
+
+    append_to(file.get_path(), "ANTMAP");
+
+    EXPECT_THROW(world_map{file.get_path()}, std::runtime_error);
+}
+
+TEST(world_map, rejects_a_size_that_doesnt_match_the_header) {
+    temporary_file file{".map"};
+
+    std::vector<world_map_nest> nests = {{1, 2}};
+    std::vector<world_map_food> food = {{5, 6, 100}};
+
+    write_world_map(file.get_path(), 10, 10, nests, food);
+
+    append_to(file.get_path(), "x");
+
+    EXPECT_THROW(world_map{file.get_path()}, std::runtime_error);
+
+    EXPECT_THROW(world_map{std::filesystem::temp_directory_path() / "ant_sim_no_such_map.map"}, std::runtime_error);
+}
+
+// Creates a simulation from a map with the given nests and food
+std::unique_ptr<simulation> load_map(const temporary_file& file, std::vector<world_map_nest> nests,
+                                     std::vector<world_map_food> food) {
+    write_world_map(file.get_path(), 10, 10, nests, food);
+
+    auto args = quiet_args(1);
+    args.map = std::make_shared<const world_map>(file.get_path());
+
+    return std::make_unique<simulation>(args);
+}
+
+TEST(world_map, loads_into_a_simulation) {
+    temporary_file file{".map"};
+
+    auto sim = load_map(file, {{1, 2}, {8, 9}}, {{5, 6, 100}, {0, 0, 20}});
+
+    EXPECT_EQ(sim->get_tiles().extent(0), 10);
+    EXPECT_EQ(sim->get_tiles().extent(1), 10);
+
+    ASSERT_EQ(sim->get_nests().size(), 2);
+    EXPECT_EQ(sim->get_nests()[1].location, (point<>{8, 9}));
+
+    EXPECT_EQ(sim->get_food_sources().size(), 2);
+    EXPECT_EQ(sim->get_food_supply({5, 6}), 100);
+    EXPECT_EQ(sim->get_food_count(), 120);
+}
+
+TEST(world_map, load_rejects_invalid_worlds) {
+    temporary_file file{".map"};
+
+    EXPECT_THROW(load_map(file, {{10, 0}}, {}), std::runtime_error);               // Nest outside of the world
+    EXPECT_THROW(load_map(file, {{1, 1}, {1, 1}}, {}), std::runtime_error);        // Two nests on one tile
+    EXPECT_THROW(load_map(file, {{1, 1}}, {{0, 10, 5}}), std::runtime_error);      // Food outside of the world
+    EXPECT_THROW(load_map(file, {{1, 1}}, {{2, 2, 0}}), std::runtime_error);       // Food source without food
+    EXPECT_THROW(load_map(file, {{1, 1}}, {{2, 2, 5}, {2, 2, 5}}), std::runtime_error); // Two food sources on one tile
+}
+
+// Pheromone trails
+
+using trails_type = basic_pheromone_trails<exact_pheromone_encoding>;
+using pool_type = trails_type::pool_type;
+
+TEST(pheromone_trails, starts_untouched) {
+    trails_type trails{};
+
+    EXPECT_EQ(trails.entry_count(), 0);
+    EXPECT_TRUE(trails.is_untouched(0));
+    EXPECT_EQ(trails.get_strength(0, 0), 0);
+}
+
+TEST(pheromone_trails, deposits_into_an_entry_per_nest) {
+    trails_type trails{};
+    pool_type pool;
+
+    trails.deposit(3, 0, 5, 0, 0, 0, pool);
+    trails.deposit(3, 1, 2, 0, 0, 0, pool);
+    trails.deposit(3, 0, 1, 0, 0, 0, pool);
+
+    EXPECT_EQ(trails.entry_count(), 1);
+    EXPECT_FALSE(trails.is_untouched(3));
+    EXPECT_TRUE(trails.is_untouched(4));
+    EXPECT_EQ(trails.get_strength(3, 0), 6);
+    EXPECT_EQ(trails.get_strength(3, 1), 2);
+    EXPECT_EQ(pool.blocks_in_use(), 0);
+}
+
+TEST(pheromone_trails, overflows_into_the_pool) {
+    trails_type trails{};
+    pool_type pool;
+
+    constexpr nest_id_t nest_count = 10;
+
+    for(nest_id_t nest_id = 0; nest_id < nest_count; nest_id++) {
+        trails.deposit(nest_id, 0, static_cast<pheromone_strength_t>(nest_id + 1), 0, 0, 0, pool);
+    }
+
+    auto per_block = trails_type::block_type::capacity;
+    auto overflowing = nest_count - trails_type::inline_capacity;
+
+    EXPECT_EQ(trails.entry_count(), nest_count);
+    EXPECT_EQ(pool.blocks_in_use(), (overflowing + per_block - 1) / per_block);
+
+    for(nest_id_t nest_id = 0; nest_id < nest_count; nest_id++) {
+        EXPECT_EQ(trails.get_strength(nest_id, 0), static_cast<pheromone_strength_t>(nest_id + 1));
+    }
+
+    std::set<nest_id_t> visited;
+    trails.for_each_entry([&](const auto& entry) { visited.insert(entry.nest_id); });
+
+    EXPECT_EQ(visited.size(), nest_count);
+}
+
+TEST(pheromone_trails, erases_faded_entries_and_releases_their_blocks) {
+    trails_type trails{};
+    pool_type pool;
+
+    for(nest_id_t nest_id = 0; nest_id < 10; nest_id++) {
+        trails.deposit(nest_id, 0, 1, 0, 1, 0, pool);
+    }
+
+    // Stronger than the rest, so it is still there after they have faded
+    trails.deposit(7, 1, 10, 0, 1, 0, pool);
+
+    ASSERT_GT(pool.blocks_in_use(), 0);
+
+    // Faded entries are only removed when the tile is written to
+    EXPECT_EQ(trails.get_current_strength(0, 0, 5, 1, 0), 0);
+    EXPECT_EQ(trails.entry_count(), 10);
+
+    trails.deposit(2, 0, 3, 5, 1, 0, pool);
+
+    EXPECT_EQ(trails.entry_count(), 2);
+    EXPECT_EQ(pool.blocks_in_use(), 0);
+    EXPECT_EQ(trails.get_current_strength(7, 1, 5, 1, 0), 5);
+    EXPECT_EQ(trails.get_current_strength(2, 0, 5, 1, 0), 3);
+    EXPECT_TRUE(trails.is_untouched(0));
+
+    // Released blocks are reused
+    for(nest_id_t nest_id = 10; nest_id < 20; nest_id++) {
+        trails.deposit(nest_id, 0, 1, 5, 1, 0, pool);
+    }
+
+    EXPECT_EQ(trails.entry_count(), 12);
+    EXPECT_EQ(pool.blocks_in_use(), 2);
+}
+
+TEST(pheromone_trails, compact_strengths_saturate) {
+    using encoding = compact_pheromone_encoding;
+
+    EXPECT_EQ(encoding::decode_strength(encoding::encode_strength(-5)), 0);
+    EXPECT_EQ(encoding::decode_strength(encoding::encode_strength(100)), 100);
+    EXPECT_EQ(encoding::decode_strength(encoding::encode_strength(200)), 200);
+    EXPECT_EQ(encoding::decode_strength(encoding::encode_strength(1000)), encoding::max_strength);
+    EXPECT_GT(encoding::max_strength, 255);
+}
+
+// Statistics history
+
+TEST(stats_history, merges_pairs_once_full) {
+    stats_history history;
+
+    std::vector<float> values(history.get_series_count());
+
+    auto record = [&](float value) {
+        std::ranges::fill(values, value);
+        history.record(values);
+    };
+
+    for(auto tick = 0uz; tick < stats_history::capacity; tick++) {
+        record(static_cast<float>(tick));
+    }
+
+    stats_history::snapshot snapshot;
+    history.read(snapshot);
+
+    // Each sample is now the mean of two ticks
+    ASSERT_EQ(snapshot.count, stats_history::capacity / 2);
+    EXPECT_EQ(snapshot.stride, 2);
+
+    const auto* ant_counts = snapshot.get_series(stats_history::ant_count);
+
+    for(auto i = 0uz; i < snapshot.count; i++) {
+        EXPECT_EQ(ant_counts[i], static_cast<float>(i * 2) + 0.5f);
+    }
+
+    // A sample is only added once a whole stride has been recorded
+    record(1000);
+    history.read(snapshot);
+    EXPECT_EQ(snapshot.count, stats_history::capacity / 2);
+
+    record(2000);
+    history.read(snapshot);
+    ASSERT_EQ(snapshot.count, stats_history::capacity / 2 + 1);
+    EXPECT_EQ(snapshot.get_series(stats_history::deaths)[snapshot.count - 1], 1500);
+}
+
+// World generation
+
+TEST(generation, places_food_at_the_food_chance) {
+    constexpr std::uint64_t seed_count = 50;
+
+    auto args = quiet_args(0);
+    args.rows = 200;
+    args.columns = 200;
+
+    auto tile_count = args.rows * args.columns;
+    double total_food_sources = 0;
+
+    for(std::uint64_t seed = 0; seed < seed_count; seed++) {
+        args.seed = seed;
+
+        simulation sim{args};
+
+        auto food_sources = sim.get_food_sources();
+
+        // Placed in order, one tile after another, so each tile holds at most one food source
+        for(auto i = 0uz; i < food_sources.size(); i++) {
+            auto [x, y] = food_sources[i];
+
+            ASSERT_LT(x, args.columns);
+            ASSERT_LT(y, args.rows);
+            EXPECT_GT(sim.get_food_supply({x, y}), 0);
+
+            if(i != 0) {
+                auto [previous_x, previous_y] = food_sources[i - 1];
+                EXPECT_LT(previous_y * args.columns + previous_x, y * args.columns + x);
+            }
+        }
+
+        // Every generated food source starts with the same supply
+        EXPECT_EQ(sim.get_food_count(), static_cast<double>(food_sources.size()) * 255);
+
+        total_food_sources += static_cast<double>(food_sources.size());
+    }
+
+    // The count is binomially distributed, so the mean over every seed should be within a few standard errors
+    auto chance = static_cast<double>(simulation::default_food_chance);
+    auto expected = static_cast<double>(tile_count) * chance;
+    auto standard_error = std::sqrt(expected * (1 - chance) / seed_count);
+
+    EXPECT_NEAR(total_food_sources / seed_count, expected, 5 * standard_error);
+}
+
+TEST(generation, gives_every_nest_its_own_tile) {
+    auto args = quiet_args(5);
+    args.rows = 10;
+    args.columns = 10;
+    args.nest_count = 100;
+    args.ant_count_per_nest = 1;
+
+    simulation sim{args};
+
+    std::set<std::pair<std::size_t, std::size_t>> locations;
+
+    for(const auto& nest : sim.get_nests()) {
+        locations.insert({nest.location.x, nest.location.y});
+    }
+
+    EXPECT_EQ(locations.size(), 100);
+
+    args.nest_count = 101;
+    EXPECT_THROW(simulation{args}, std::runtime_error);
+}
+
+} // namespace